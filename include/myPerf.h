@@ -0,0 +1 @@
+../src/util/myPerf.h
\ No newline at end of file
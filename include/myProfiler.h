@@ -0,0 +1 @@
+../src/util/myProfiler.h
\ No newline at end of file
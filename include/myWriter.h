@@ -0,0 +1 @@
+../src/util/myWriter.h
\ No newline at end of file
@@ -0,0 +1,4 @@
+bench.o: bench.cpp ../cir/cirMgr.h ../cir/cirDef.h ../cir/cirGate.h \
+ ../cir/cirGate.h ../cir/cirCut.h ../../include/util.h \
+ ../../include/rnGen.h ../../include/myUsage.h ../../include/myProfiler.h \
+ ../../include/myPerf.h
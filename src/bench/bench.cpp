@@ -0,0 +1,449 @@
+/****************************************************************************
+  FileName     [ bench.cpp ]
+  PackageName  [ bench ]
+  Synopsis     [ Define the benchmark driver of the cir package ]
+  Author       [ Chung-Yang (Ric) Huang ]
+  Copyright    [ Copyleft(c) 2008-present LaDs(III), GIEE, NTU, Taiwan ]
+****************************************************************************/
+
+#include <cstdlib>
+#include <climits>
+#include <cmath>
+#include <iostream>
+#include <iomanip>
+#include <sstream>
+#include <algorithm>
+#include <chrono>
+#include <glob.h>
+#include <unistd.h>
+#include <sys/wait.h>
+#include <sys/resource.h>
+#include <stdint.h>
+#include "cirMgr.h"
+#include "cirGate.h"
+#include "cirCut.h"
+#include "util.h"
+
+using namespace std;
+
+//----------------------------------------------------------------------
+//    Benchmark cases
+//----------------------------------------------------------------------
+#define BENCH_SIM_WORDS   8
+
+// Swallows everything written to it
+class BenchNullBuf: public streambuf
+{
+protected:
+   int overflow(int c) { return c; }
+   streamsize xsputn(const char*, streamsize n) { return n; }
+};
+
+static BenchNullBuf nullBuf;
+static ostream nullStream(&nullBuf);
+
+// The state of one operation on one file
+struct BenchCase
+{
+   BenchCase(const string& f): _file(f), _mgr(0), _ref(0) {}
+   ~BenchCase() { delete _mgr; delete _ref; }
+
+   string             _file;
+   CirMgr*            _mgr;
+   CirMgr*            _ref;
+   vector<uint64_t>   _pi;
+   vector<uint64_t>   _val;
+};
+
+static bool
+readFresh(BenchCase& bc)
+{
+   delete bc._mgr;
+   bc._mgr = new CirMgr;
+   return bc._mgr->readCircuit(bc._file);
+}
+
+static bool
+readOnce(BenchCase& bc)
+{
+   return bc._mgr || readFresh(bc);
+}
+
+// parse: the .aag is parsed; load: the binary cache is loaded
+static bool
+prepareParse(BenchCase& bc)
+{
+   CirMgr::enableCache(false);
+   delete bc._mgr;
+   bc._mgr = new CirMgr;
+   return true;
+}
+
+static bool
+prepareLoad(BenchCase& bc)
+{
+   CirMgr::enableCache(true);
+   delete bc._mgr;
+   bc._mgr = new CirMgr;
+   return true;
+}
+
+static bool
+runRead(BenchCase& bc)
+{
+   return bc._mgr->readCircuit(bc._file);
+}
+
+static bool
+runDfs(BenchCase& bc)
+{
+   GateList dfsTl;
+   CirTravContext ctx(bc._mgr->getGateIdEnd());
+   bc._mgr->dfsOrder(dfsTl, ctx);
+   return true;
+}
+
+static bool
+runPrint(BenchCase& bc)
+{
+   bc._mgr->printNetlist();
+   return true;
+}
+
+static bool
+runWrite(BenchCase& bc)
+{
+   bc._mgr->writeAag(nullStream);
+   return true;
+}
+
+static bool
+runStrash(BenchCase& bc)
+{
+   bc._mgr->buildStrash();
+   return true;
+}
+
+// BENCH_SIM_WORDS words of random patterns, the same in every run
+static bool
+prepareSim(BenchCase& bc)
+{
+   if (!readOnce(bc)) return false;
+   const size_t nPi = bc._mgr->getPIs().size();
+   if (bc._pi.size() != nPi * BENCH_SIM_WORDS) {
+      RandomNumGen gen(1);
+      bc._pi.resize(nPi * BENCH_SIM_WORDS);
+      for (size_t i = 0; i < bc._pi.size(); i++)
+         for (unsigned b = 0; b < 64; b += 16)
+            bc._pi[i] |= uint64_t(gen(1 << 16)) << b;
+   }
+   bc._val.assign(size_t(bc._mgr->getGateIdEnd()) * BENCH_SIM_WORDS, 0);
+   bc._mgr->getDfsList();
+   return true;
+}
+
+// Bit-parallel simulation in DFS order
+static bool
+runSim(BenchCase& bc)
+{
+   MY_PERF_SCOPE(perf, "bench/sim");
+   const GateList& pi = bc._mgr->getPIs();
+   for (size_t i = 0; i < pi.size(); i++)
+      for (unsigned w = 0; w < BENCH_SIM_WORDS; w++)
+         bc._val[pi[i]->_id * BENCH_SIM_WORDS + w] = bc._pi[i * BENCH_SIM_WORDS + w];
+   const GateList& dfsTl = bc._mgr->getDfsList();
+   MY_PERF_GATES(perf, dfsTl.size() * BENCH_SIM_WORDS);
+   for (size_t i = 0; i < dfsTl.size(); i++) {
+      const CirGate* g = dfsTl[i];
+      if (g->_type != AIG_GATE && g->_type != PO_GATE) continue;
+      uint64_t* v = &bc._val[g->_id * BENCH_SIM_WORDS];
+      const uint64_t* a = &bc._val[g->_fanin[0]->_id * BENCH_SIM_WORDS];
+      const uint64_t ia = g->_invert[0] ? ~uint64_t(0) : 0;
+      if (g->_type == PO_GATE) {
+         for (unsigned w = 0; w < BENCH_SIM_WORDS; w++) v[w] = a[w] ^ ia;
+         continue;
+      }
+      const uint64_t* b = &bc._val[g->_fanin[1]->_id * BENCH_SIM_WORDS];
+      const uint64_t ib = g->_invert[1] ? ~uint64_t(0) : 0;
+      for (unsigned w = 0; w < BENCH_SIM_WORDS; w++)
+         v[w] = (a[w] ^ ia) & (b[w] ^ ib);
+   }
+   return true;
+}
+
+// sweep: simulation and SAT sweeping of the circuit against its balanced
+// version (CIRCEC)
+static bool
+prepareSweep(BenchCase& bc)
+{
+   if (!readOnce(bc)) return false;
+   if (!bc._ref) {
+      bc._ref = new CirMgr;
+      if (!bc._ref->readCircuit(bc._file)) return false;
+      bc._ref->balance();
+   }
+   return true;
+}
+
+static bool
+runSweep(BenchCase& bc)
+{
+   bc._mgr->cec(*bc._ref);
+   return true;
+}
+
+static bool
+runRewrite(BenchCase& bc)
+{
+   bc._mgr->rewrite();
+   return true;
+}
+
+static bool
+runBalance(BenchCase& bc)
+{
+   bc._mgr->balance();
+   return true;
+}
+
+// cuts: 6-input priority cuts of all the gates kept to the end; cutslvl:
+// each level is reclaimed once its last fanout has its cuts, so the peak
+// RSS shows the gain and nothing may be left after the enumeration
+static bool
+runCuts(BenchCase& bc)
+{
+   CirCutMgr cuts(6, 8, true);
+   cuts.enumerate(bc._mgr);
+   return cuts.getMemUsage() > 0 || bc._mgr->getDfsList().size() == 0;
+}
+
+static bool
+runCutsLevel(BenchCase& bc)
+{
+   CirCutMgr cuts(6, 8, false);
+   cuts.enumerate(bc._mgr);
+   return cuts.getMemUsage() == 0;
+}
+
+// prepare() is not timed
+struct BenchOp
+{
+   const char*  _name;
+   bool         (*_prepare)(BenchCase&);
+   bool         (*_run)(BenchCase&);
+};
+
+static const BenchOp benchOps[] = {
+   { "parse",   prepareParse, runRead },
+   { "load",    prepareLoad,  runRead },
+   { "dfs",     readOnce,     runDfs },
+   { "print",   readOnce,     runPrint },
+   { "write",   readOnce,     runWrite },
+   { "strash",  readFresh,    runStrash },
+   { "sim",     prepareSim,   runSim },
+   { "sweep",   prepareSweep, runSweep },
+   { "rewrite", readFresh,    runRewrite },
+   { "balance", readFresh,    runBalance },
+   { "cuts",    readOnce,     runCuts },
+   { "cutslvl", readOnce,     runCutsLevel }
+};
+static const size_t nBenchOps = sizeof(benchOps) / sizeof(benchOps[0]);
+
+//----------------------------------------------------------------------
+//    Benchmark driver
+//----------------------------------------------------------------------
+static void
+usage()
+{
+   cout << "Usage: cirBench [-Repeat <(int n)>] [-Warmup <(int n)>] "
+        << "[-Op <(string op)[,op...]>] [aagFile...]" << endl;
+   cout << "  ops:";
+   for (size_t i = 0; i < nBenchOps; i++) cout << ' ' << benchOps[i]._name;
+   cout << endl;
+   cout << "  default files: tests.fraig/*.aag tests.fraig/ISCAS85/*.aag"
+        << endl;
+}
+
+static void
+myexit()
+{
+   usage();
+   exit(-1);
+}
+
+static void
+globFiles(const string& pattern, vector<string>& files)
+{
+   glob_t g;
+   if (glob(pattern.c_str(), 0, 0, &g) == 0)
+      for (size_t i = 0; i < g.gl_pathc; i++) files.push_back(g.gl_pathv[i]);
+   globfree(&g);
+}
+
+// p-th percentile by the nearest rank; the median averages the middle two
+static double
+percentile(const vector<double>& t, double p)
+{
+   const size_t rank = size_t(ceil(p * t.size()));
+   return t[rank ? rank - 1 : 0];
+}
+
+static double
+median(const vector<double>& t)
+{
+   const size_t n = t.size();
+   return (n % 2) ? t[n / 2] : (t[n / 2 - 1] + t[n / 2]) / 2;
+}
+
+// The cases read the files through links in a temporary directory, so
+// the caches written by the reads stay out of the input directories
+static bool
+linkFiles(const vector<string>& files, string& dir, vector<string>& links)
+{
+   char tmpl[] = "/tmp/cirBench.XXXXXX";
+   if (!mkdtemp(tmpl)) {
+      cerr << "Error: cannot create a temporary directory!!\n";
+      return false;
+   }
+   dir = tmpl;
+   for (size_t f = 0; f < files.size(); f++) {
+      // a file that cannot be resolved is read as given and fails there
+      char path[PATH_MAX];
+      if (!realpath(files[f].c_str(), path)) {
+         links.push_back(files[f]);
+         continue;
+      }
+      links.push_back(dir + "/" + to_string(f) + ".aag");
+      if (symlink(path, links.back().c_str()) != 0) {
+         cerr << "Error: cannot link \"" << files[f] << "\" in \"" << dir
+              << "\"!!\n";
+         return false;
+      }
+   }
+   return true;
+}
+
+static void
+removeLinks(const string& dir, const vector<string>& links)
+{
+   for (size_t f = 0; f < links.size(); f++) {
+      if (links[f].compare(0, dir.size() + 1, dir + "/") != 0) continue;
+      unlink(links[f].c_str());
+      unlink((links[f] + ".cache").c_str());
+   }
+   if (dir.size()) rmdir(dir.c_str());
+}
+
+// Run one operation on the file read through link and write its CSV row
+// to os
+static bool
+benchOne(const string& file, const string& link, const BenchOp& op,
+         unsigned warmup, unsigned repeat, ostream& os)
+{
+   BenchCase bc(link);
+   vector<double> ms;
+   for (unsigned r = 0; r < warmup + repeat; r++) {
+      if (!op._prepare(bc)) return false;
+      chrono::steady_clock::time_point t0 = chrono::steady_clock::now();
+      if (!op._run(bc)) return false;
+      chrono::steady_clock::time_point t1 = chrono::steady_clock::now();
+      if (r >= warmup)
+         ms.push_back(chrono::duration<double, milli>(t1 - t0).count());
+      CirMgr::enableCache(true);
+   }
+   sort(ms.begin(), ms.end());
+   struct rusage usage;
+   getrusage(RUSAGE_SELF, &usage);
+
+   os << file << ',' << op._name << ',' << bc._mgr->getAIGs().size() << ','
+      << repeat << ',' << fixed << setprecision(3) << median(ms) << ','
+      << percentile(ms, 0.95) << ',' << usage.ru_maxrss << endl;
+   return true;
+}
+
+int
+main(int argc, char** argv)
+{
+   unsigned warmup = 1, repeat = 5;
+   vector<const BenchOp*> ops;
+   vector<string> files;
+   for (int i = 1; i < argc; i++) {
+      const string arg = argv[i];
+      if (myStrNCmp("-Repeat", arg, 2) == 0 || myStrNCmp("-Warmup", arg, 2) == 0) {
+         const bool isRepeat = myStrNCmp("-Repeat", arg, 2) == 0;
+         int n;
+         if (++i == argc || !myStr2Int(argv[i], n) || n < (isRepeat ? 1 : 0)) {
+            cerr << "Error: illegal count for \"" << arg << "\"!!\n";
+            myexit();
+         }
+         (isRepeat ? repeat : warmup) = n;
+      }
+      else if (myStrNCmp("-Op", arg, 2) == 0) {
+         if (++i == argc) {
+            cerr << "Error: missing operation!!\n";
+            myexit();
+         }
+         string list = argv[i], name;
+         for (size_t pos = myStrGetTok(list, name, 0, ','); name.size();
+              pos = myStrGetTok(list, name, pos, ',')) {
+            size_t k = 0;
+            while (k < nBenchOps && name != benchOps[k]._name) ++k;
+            if (k == nBenchOps) {
+               cerr << "Error: unknown operation \"" << name << "\"!!\n";
+               myexit();
+            }
+            ops.push_back(&benchOps[k]);
+         }
+      }
+      else if (arg.size() && arg[0] == '-') {
+         cerr << "Error: unknown argument \"" << arg << "\"!!\n";
+         myexit();
+      }
+      else files.push_back(arg);
+   }
+   if (ops.empty())
+      for (size_t k = 0; k < nBenchOps; k++) ops.push_back(&benchOps[k]);
+   if (files.empty()) {
+      globFiles("tests.fraig/*.aag", files);
+      globFiles("tests.fraig/ISCAS85/*.aag", files);
+   }
+   if (files.empty()) {
+      cerr << "Error: no .aag file is found!!\n";
+      myexit();
+   }
+
+   string dir;
+   vector<string> links;
+   if (!linkFiles(files, dir, links)) {
+      removeLinks(dir, links);
+      return 1;
+   }
+
+   // Each case runs in its own process, so that the peak RSS is its own
+   // and the reports of the operations go to a null stream
+   cout << "file,op,aig,repeat,median_ms,p95_ms,peak_rss_kb" << endl;
+   int status = 0;
+   for (size_t f = 0; f < files.size(); f++)
+      for (size_t k = 0; k < ops.size(); k++) {
+         pid_t pid = fork();
+         if (pid == 0) {
+            ostream csv(cout.rdbuf());
+            cout.rdbuf(&nullBuf);
+            const bool ok = benchOne(files[f], links[f], *ops[k], warmup,
+                                     repeat, csv);
+            MY_PERF_REPORT(cerr);
+            cout.rdbuf(csv.rdbuf());
+            _exit(ok ? 0 : 1);
+         }
+         int st = -1;
+         if (pid < 0 || waitpid(pid, &st, 0) < 0 || !WIFEXITED(st) ||
+             WEXITSTATUS(st) != 0) {
+            cerr << "Error: " << ops[k]->_name << " on \"" << files[f]
+                 << "\" failed!!" << endl;
+            status = 1;
+         }
+      }
+   removeLinks(dir, links);
+
+   return status;
+}
@@ -1,7 +1,55 @@
-cirCmd.o: cirCmd.cpp cirMgr.h cirDef.h cirGate.h cirCmd.h \
- ../../include/cmdParser.h ../../include/cmdCharDef.h \
- ../../include/util.h ../../include/rnGen.h ../../include/myUsage.h
+cirBalance.o: cirBalance.cpp cirMgr.h cirDef.h cirGate.h \
+ ../../include/util.h ../../include/rnGen.h ../../include/myUsage.h \
+ ../../include/myProfiler.h ../../include/myPerf.h
+cirCache.o: cirCache.cpp cirMgr.h cirDef.h cirGate.h ../../include/util.h \
+ ../../include/rnGen.h ../../include/myUsage.h ../../include/myProfiler.h \
+ ../../include/myPerf.h
+cirCec.o: cirCec.cpp cirMgr.h cirDef.h cirGate.h cirSat.h \
+ ../../include/util.h ../../include/rnGen.h ../../include/myUsage.h \
+ ../../include/myProfiler.h ../../include/myPerf.h
+cirCmd.o: cirCmd.cpp cirMgr.h cirDef.h cirGate.h cirCut.h cirCmd.h \
+ ../../include/cmdParser.h ../../include/cmdCharDef.h cirGen.h \
+ ../../include/rnGen.h ../../include/util.h ../../include/rnGen.h \
+ ../../include/myUsage.h ../../include/myProfiler.h \
+ ../../include/myPerf.h
+cirCut.o: cirCut.cpp cirCut.h cirDef.h cirMgr.h cirGate.h \
+ ../../include/util.h ../../include/rnGen.h ../../include/myUsage.h \
+ ../../include/myProfiler.h ../../include/myPerf.h
+cirExtract.o: cirExtract.cpp cirMgr.h cirDef.h cirGate.h \
+ ../../include/util.h ../../include/rnGen.h ../../include/myUsage.h \
+ ../../include/myProfiler.h ../../include/myPerf.h
+cirFault.o: cirFault.cpp cirMgr.h cirDef.h cirGate.h ../../include/util.h \
+ ../../include/rnGen.h ../../include/myUsage.h ../../include/myProfiler.h \
+ ../../include/myPerf.h
 cirGate.o: cirGate.cpp cirGate.h cirDef.h cirMgr.h ../../include/util.h \
- ../../include/rnGen.h ../../include/myUsage.h
+ ../../include/rnGen.h ../../include/myUsage.h ../../include/myProfiler.h \
+ ../../include/myPerf.h ../../include/myWriter.h
+cirGen.o: cirGen.cpp cirGen.h ../../include/rnGen.h \
+ ../../include/myWriter.h
+cirMap.o: cirMap.cpp cirMgr.h cirDef.h cirGate.h cirCut.h \
+ ../../include/util.h ../../include/rnGen.h ../../include/myUsage.h \
+ ../../include/myProfiler.h ../../include/myPerf.h
 cirMgr.o: cirMgr.cpp cirMgr.h cirDef.h cirGate.h ../../include/util.h \
- ../../include/rnGen.h ../../include/myUsage.h
+ ../../include/rnGen.h ../../include/myUsage.h ../../include/myProfiler.h \
+ ../../include/myPerf.h ../../include/myWriter.h
+cirNpn.o: cirNpn.cpp cirNpn.h
+cirOpt.o: cirOpt.cpp cirMgr.h cirDef.h cirGate.h ../../include/util.h \
+ ../../include/rnGen.h ../../include/myUsage.h ../../include/myProfiler.h \
+ ../../include/myPerf.h
+cirPower.o: cirPower.cpp cirMgr.h cirDef.h cirGate.h ../../include/util.h \
+ ../../include/rnGen.h ../../include/myUsage.h ../../include/myProfiler.h \
+ ../../include/myPerf.h
+cirQuery.o: cirQuery.cpp cirMgr.h cirDef.h cirGate.h ../../include/util.h \
+ ../../include/rnGen.h ../../include/myUsage.h ../../include/myProfiler.h \
+ ../../include/myPerf.h
+cirRewrite.o: cirRewrite.cpp cirMgr.h cirDef.h cirGate.h cirCut.h \
+ cirNpn.h ../../include/util.h ../../include/rnGen.h \
+ ../../include/myUsage.h ../../include/myProfiler.h \
+ ../../include/myPerf.h
+cirSat.o: cirSat.cpp cirSat.h
+cirSnap.o: cirSnap.cpp cirMgr.h cirDef.h cirGate.h ../../include/util.h \
+ ../../include/rnGen.h ../../include/myUsage.h ../../include/myProfiler.h \
+ ../../include/myPerf.h ../../include/myWriter.h
+cirTiming.o: cirTiming.cpp cirMgr.h cirDef.h cirGate.h \
+ ../../include/util.h ../../include/rnGen.h ../../include/myUsage.h \
+ ../../include/myProfiler.h ../../include/myPerf.h
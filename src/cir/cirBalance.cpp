@@ -0,0 +1,170 @@
+/****************************************************************************
+  FileName     [ cirBalance.cpp ]
+  PackageName  [ cir ]
+  Synopsis     [ Define AIG balancing for depth reduction ]
+  Author       [ Chung-Yang (Ric) Huang ]
+  Copyright    [ Copyleft(c) 2008-present LaDs(III), GIEE, NTU, Taiwan ]
+****************************************************************************/
+
+#include <iostream>
+#include <cassert>
+#include <algorithm>
+#include "cirMgr.h"
+#include "cirGate.h"
+#include "util.h"
+
+using namespace std;
+
+/**************************************/
+/*   Static varaibles and functions   */
+/**************************************/
+// Rebuild every AND supergate (a tree of gates connected by non-inverted
+// single-fanout edges) as a minimum-depth tree.  The new gates are
+// structurally hashed as they are created.
+class CirBalancer
+{
+public:
+   CirBalancer(CirMgr* mgr): _mgr(mgr) {}
+
+   void balance();
+
+private:
+   CirMgr*             _mgr;
+   vector<CirGateV>    _result;   // indexed by old gate id
+   vector<char>        _done;     // indexed by old gate id
+   vector<unsigned>    _level;    // indexed by gate id
+
+   unsigned& level(CirGate* g) {
+      if (g->_id >= _level.size()) _level.resize(g->_id + 1, 0);
+      return _level[g->_id];
+   }
+   void collect(CirGate*, vector<CirGateV>&) const;
+   CirGateV balance(CirGate*);
+   CirGateV buildTree(vector<CirGateV>&);
+};
+
+// Collect the leaves of the supergate rooted at g
+void
+CirBalancer::collect(CirGate* g, vector<CirGateV>& leaves) const
+{
+   for (size_t j = 0; j < g->_fanin.size(); ++j) {
+      CirGateV v = g->getFanin(j);
+      CirGate* f = v.gate();
+      if (!v.isInv() && f->_type == AIG_GATE && f->_fanout.size() == 1)
+         collect(f, leaves);
+      else leaves.push_back(v);
+   }
+}
+
+struct CirLevelLess
+{
+   CirLevelLess(const vector<unsigned>& l): _level(l) {}
+   bool operator () (const CirGateV& a, const CirGateV& b) const {
+      return _level[a.gate()->_id] < _level[b.gate()->_id];
+   }
+   const vector<unsigned>& _level;
+};
+
+// Pair the two earliest arriving literals until one is left
+CirGateV
+CirBalancer::buildTree(vector<CirGateV>& lits)
+{
+   CirLevelLess less(_level);
+   sort(lits.begin(), lits.end(), less);
+   size_t head = 0;
+   while (lits.size() - head > 1) {
+      CirGateV v = _mgr->strashAnd(lits[head], lits[head + 1]);
+      head += 2;
+      if (v.gate()->_type == AIG_GATE && level(v.gate()) == 0)
+         level(v.gate()) = 1 + max(_level[lits[head - 2].gate()->_id],
+                                   _level[lits[head - 1].gate()->_id]);
+      // keep lits[head..] sorted
+      vector<CirGateV>::iterator it =
+         upper_bound(lits.begin() + head, lits.end(), v, less);
+      lits.insert(it, v);
+   }
+   return lits[head];
+}
+
+CirGateV
+CirBalancer::balance(CirGate* g)
+{
+   if (g->_type != AIG_GATE) return CirGateV(g);
+   if (_done[g->_id]) return _result[g->_id];
+
+   vector<CirGateV> leaves;
+   collect(g, leaves);
+   vector<CirGateV> lits;
+   lits.reserve(leaves.size());
+   for (size_t i = 0; i < leaves.size(); ++i) {
+      CirGateV v = balance(leaves[i].gate()) ^ leaves[i].isInv();
+      level(v.gate());
+      lits.push_back(v);
+   }
+   // x & x = x; x & !x = 0
+   sort(lits.begin(), lits.end(), [](const CirGateV& a, const CirGateV& b) {
+      return a.gate()->_id < b.gate()->_id ||
+             (a.gate()->_id == b.gate()->_id && a.isInv() < b.isInv()); });
+   lits.erase(unique(lits.begin(), lits.end()), lits.end());
+   CirGateV r;
+   for (size_t i = 1; i < lits.size() && !r.gate(); ++i)
+      if (lits[i] == !lits[i - 1]) r = _mgr->getConst();
+   if (!r.gate()) r = buildTree(lits);
+
+   _done[g->_id] = true;
+   _result[g->_id] = r;
+   return r;
+}
+
+void
+CirBalancer::balance()
+{
+   const unsigned nIds = _mgr->getGateIdEnd();
+   _result.resize(nIds);
+   _done.assign(nIds, 0);
+   _level.assign(nIds, 0);
+
+   _mgr->buildStrash();
+   const GateList& po = _mgr->getPOs();
+   GateList roots;
+   for (size_t i = 0; i < po.size(); ++i) {
+      CirGate* f = po[i]->_fanin[0];
+      CirGateV v = balance(f);
+      if (v.gate() == f) continue;
+      // reconnect the PO; the old cone is freed below once unused
+      _mgr->setFanin(po[i], 0, v);
+      roots.push_back(f);
+   }
+   for (size_t i = 0; i < roots.size(); ++i)
+      _mgr->deleteUnused(roots[i]);
+   _mgr->cleanGarbage();
+}
+
+/**************************************************************/
+/*   class CirMgr member functions for circuit optimization   */
+/**************************************************************/
+unsigned
+CirMgr::getDepth() const
+{
+  const GateList& dfsTl = getDfsList();
+  vector<unsigned> level(getGateIdEnd(), 0);
+  unsigned depth = 0;
+  for (size_t i = 0; i < dfsTl.size(); i++) {
+    CirGate* g = dfsTl[i];
+    if (g->_type != AIG_GATE) continue;
+    level[g->_id] = 1 + max(level[g->_fanin[0]->_id], level[g->_fanin[1]->_id]);
+    if (level[g->_id] > depth) depth = level[g->_id];
+  }
+  return depth;
+}
+
+void
+CirMgr::balance()
+{
+  const size_t before = _aig.size();
+  const unsigned depth = getDepth();
+  CirBalancer balancer(this);
+  balancer.balance();
+  cout << "Balancing: depth " << depth << " -> " << getDepth() << ", "
+       << before << " AIG(s) -> " << _aig.size() << " AIG(s)" << endl;
+}
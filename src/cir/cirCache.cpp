@@ -0,0 +1,347 @@
+/****************************************************************************
+  FileName     [ cirCache.cpp ]
+  PackageName  [ cir ]
+  Synopsis     [ Define the binary circuit cache written next to .aag files ]
+  Author       [ Chung-Yang (Ric) Huang ]
+  Copyright    [ Copyleft(c) 2008-present LaDs(III), GIEE, NTU, Taiwan ]
+****************************************************************************/
+
+#include <cstdio>
+#include <cstring>
+#include <climits>
+#include <cassert>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include "cirMgr.h"
+#include "cirGate.h"
+#include "util.h"
+
+using namespace std;
+
+/**************************************/
+/*   Static varaibles and functions   */
+/**************************************/
+// The image is an array of 32-bit words:
+//   [magic][version][size lo/hi][mtime lo/hi][hash lo/hi][#payload words]
+//   [payload hash lo/hi], then the payload: header strings, gates (map key,
+//   id, type, line, name), fanins, fanouts, then the PI / PO / AIG / DFS
+//   lists as gate indices.
+// A string is its length followed by its bytes padded to words.  Gates are
+// referred to by their index in the _map order.
+static const unsigned CACHE_MAGIC   = 0x43524943;   // "CIRC"
+static const unsigned CACHE_VERSION = 2;
+static const size_t   CACHE_HEADER  = 11;
+
+static string
+cacheFileName(const string& fileName)
+{
+   return fileName + ".cache";
+}
+
+static uint64_t
+hashBytes(const char* p, size_t n)
+{
+   uint64_t h = 0x9e3779b97f4a7c15ULL ^ n;
+   size_t i = 0;
+   for (; i + 8 <= n; i += 8) {
+      uint64_t w;
+      memcpy(&w, p + i, 8);
+      h = (h ^ w) * 0xff51afd7ed558ccdULL;
+      h ^= h >> 32;
+   }
+   uint64_t w = 0;
+   memcpy(&w, p + i, n - i);
+   h = (h ^ w) * 0xc4ceb9fe1a85ec53ULL;
+   return h ^ (h >> 29);
+}
+
+// Read-only view of a mapped file
+class CirMappedFile
+{
+public:
+   CirMappedFile(const string& fileName): _data(0), _size(0) {
+      int fd = open(fileName.c_str(), O_RDONLY);
+      if (fd < 0) return;
+      struct stat st;
+      if (fstat(fd, &st) == 0 && st.st_size > 0) {
+         void* p = mmap(0, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+         if (p != MAP_FAILED) { _data = (const char*)p; _size = st.st_size; }
+      }
+      close(fd);
+   }
+   ~CirMappedFile() { if (_data) munmap((void*)_data, _size); }
+
+   const char* data() const { return _data; }
+   size_t size() const { return _size; }
+
+private:
+   const char*  _data;
+   size_t       _size;
+};
+
+// Bounds-checked cursor over the image words
+class CirCacheReader
+{
+public:
+   CirCacheReader(const char* p, size_t nWords): _p(p), _n(nWords), _i(0),
+      _ok(true) {}
+
+   bool ok() const { return _ok; }
+   bool done() const { return _i == _n; }
+   unsigned word() {
+      if (_i >= _n) { _ok = false; return 0; }
+      unsigned w;
+      memcpy(&w, _p + 4 * _i++, 4);
+      return w;
+   }
+   // a word that must be less than bound
+   unsigned index(size_t bound) {
+      unsigned w = word();
+      if (w >= bound) _ok = false;
+      return _ok ? w : 0;
+   }
+   string str() {
+      unsigned len = word();
+      size_t nw = (size_t(len) + 3) / 4;
+      if (!_ok || nw > _n - _i) { _ok = false; return ""; }
+      string s(_p + 4 * _i, len);
+      _i += nw;
+      return s;
+   }
+
+private:
+   const char*  _p;
+   size_t       _n;
+   size_t       _i;
+   bool         _ok;
+};
+
+static void
+putWord64(vector<unsigned>& buf, uint64_t w)
+{
+   buf.push_back(unsigned(w));
+   buf.push_back(unsigned(w >> 32));
+}
+
+static void
+putStr(vector<unsigned>& buf, const string& s)
+{
+   buf.push_back(s.size());
+   size_t b = buf.size();
+   buf.resize(b + (s.size() + 3) / 4, 0);
+   if (s.size()) memcpy(&buf[b], s.data(), s.size());
+}
+
+/************************************************************/
+/*   class CirMgr member functions for the circuit cache    */
+/************************************************************/
+bool CirMgr::_cacheEnabled = true;
+
+// Size, mtime and content hash of the source file
+bool
+CirMgr::cacheKey(const string& fileName, CirCacheKey& key)
+{
+   struct stat st;
+   if (stat(fileName.c_str(), &st) != 0) return false;
+   CirMappedFile src(fileName);
+   if (!src.data()) return false;
+   key._size = src.size();
+   key._mtime = uint64_t(st.st_mtim.tv_sec) * 1000000000ULL + st.st_mtim.tv_nsec;
+   key._hash = hashBytes(src.data(), src.size());
+   return true;
+}
+
+// Construct the circuit from the image of fileName; nothing is changed if
+// the image is missing, stale or damaged, and the caller parses the .aag
+bool
+CirMgr::loadCache(const string& fileName, const CirCacheKey& key)
+{
+  CirMappedFile image(cacheFileName(fileName));
+  if (!image.data() || image.size() % 4) return false;
+  CirCacheReader r(image.data(), image.size() / 4);
+  if (r.word() != CACHE_MAGIC || r.word() != CACHE_VERSION) return false;
+  uint64_t size = r.word(); size |= uint64_t(r.word()) << 32;
+  uint64_t mtime = r.word(); mtime |= uint64_t(r.word()) << 32;
+  uint64_t hash = r.word(); hash |= uint64_t(r.word()) << 32;
+  if (size != key._size || mtime != key._mtime || hash != key._hash)
+    return false;
+  if (r.word() != image.size() / 4 - CACHE_HEADER) return false;
+  uint64_t payload = r.word(); payload |= uint64_t(r.word()) << 32;
+  if (!r.ok() || payload != hashBytes(image.data() + 4 * CACHE_HEADER,
+                                      image.size() - 4 * CACHE_HEADER))
+    return false;
+
+  vector<string> header(r.index(image.size()));
+  for (size_t i = 0; i < header.size(); i++) header[i] = r.str();
+
+  // there is always the constant; the gate indices below are checked
+  // before they are used
+  const size_t nGates = r.index(image.size());
+  if (!r.ok() || !nGates) return false;
+  GateList gates(nGates, 0);
+  vector<unsigned> keys(nGates);
+  for (size_t i = 0; i < nGates && r.ok(); i++) {
+    keys[i] = r.word();
+    unsigned id = r.word();
+    unsigned type = r.word();
+    unsigned lineNo = r.word();
+    switch (type) {
+      case UNDEF_GATE: gates[i] = new CirUndefGate(id); break;
+      case PI_GATE:    gates[i] = new CirPiGate(id, lineNo); break;
+      case PO_GATE:    gates[i] = new CirPoGate(id, lineNo); break;
+      case AIG_GATE:   gates[i] = new CirAigGate(id, lineNo); break;
+      case CONST_GATE: gates[i] = new CirConstGate(); break;
+      default:         r.index(0); continue;   // mark the image as bad
+    }
+    gates[i]->_name = r.str();
+  }
+  // the image must have the structure of a circuit read from a file: the
+  // fanins of the gate type, fanouts that have the gate as a fanin, lists
+  // of the right types and the DFS list in topological order
+  const GateType listType[3] = { PI_GATE, PO_GATE, AIG_GATE };
+  vector<unsigned> fanin(2 * nGates, UINT_MAX);   // literals by index
+  for (size_t i = 0; i < nGates && r.ok(); i++) {
+    CirGate* g = gates[i];
+    const size_t n = r.index(3);
+    if (keys[i] != g->_id || (i && keys[i] <= keys[i - 1]) ||
+        n != (g->_type == AIG_GATE ? 2 : g->_type == PO_GATE ? 1 : 0))
+      r.index(0);
+    // the lists are allocated once at their final sizes
+    if (!r.ok()) break;
+    g->_fanin.resize(n);
+    g->_invert.resize(n);
+    for (size_t j = 0; j < n && r.ok(); j++) {
+      const unsigned v = r.index(2 * nGates);
+      fanin[2 * i + j] = v;
+      g->_fanin[j] = gates[v / 2];
+      g->_invert[j] = v & 1;
+    }
+  }
+  for (size_t i = 0; i < nGates && r.ok(); i++) {
+    CirGate* g = gates[i];
+    const size_t n = r.index(2 * nGates + 1);
+    if (!r.ok()) break;
+    g->_fanout.resize(n);
+    for (size_t j = 0; j < n && r.ok(); j++) {
+      const unsigned v = r.index(nGates);
+      if (fanin[2 * v] / 2 != i && fanin[2 * v + 1] / 2 != i) r.index(0);
+      g->_fanout[j] = gates[v];
+    }
+  }
+  GateList lists[4];
+  vector<char> done(nGates, 0);
+  for (size_t k = 0; k < 4 && r.ok(); k++) {
+    lists[k].resize(r.index(nGates + 1));
+    for (size_t i = 0; i < lists[k].size() && r.ok(); i++) {
+      const unsigned v = r.index(nGates);
+      if (!r.ok()) break;
+      if (k < 3 && gates[v]->_type != listType[k]) r.index(0);
+      if (k < 3) { lists[k][i] = gates[v]; continue; }
+      for (size_t j = 2 * v; j < 2 * v + 2; j++)
+        if (fanin[j] != UINT_MAX && !done[fanin[j] / 2]) r.index(0);
+      if (done[v]) r.index(0);
+      done[v] = 1;
+      lists[k][i] = gates[v];
+    }
+  }
+  if (!r.ok() || !r.done()) {
+    for (size_t i = 0; i < nGates; i++) delete gates[i];
+    return false;
+  }
+
+  for (size_t i = 0; i < nGates; i++)
+    _map.insert(_map.end(), make_pair(keys[i], gates[i]));
+  _header.swap(header);
+  _pi.swap(lists[0]);
+  _po.swap(lists[1]);
+  _aig.swap(lists[2]);
+  _dfsList.swap(lists[3]);
+  _dfsState = _netState;
+  _dfsValid = true;
+  _fileName = fileName;
+  return true;
+}
+
+// Write the image of the circuit just read from fileName.  It is written
+// to a temporary file and renamed, so concurrent readers never see a
+// partial image; failures are ignored.
+void
+CirMgr::saveCache(const string& fileName, const CirCacheKey& key) const
+{
+  typedef unordered_map<const CirGate*, unsigned> GateIndex;
+  GateIndex index(_map.size() * 2);
+  unsigned nGates = 0;
+  for (map<unsigned, CirGate*>::const_iterator it = _map.begin();
+       it != _map.end(); ++it) {
+    if (!it->second || !index.insert(make_pair(it->second, nGates++)).second)
+      return;
+  }
+
+  vector<unsigned> buf;
+  buf.push_back(CACHE_MAGIC);
+  buf.push_back(CACHE_VERSION);
+  putWord64(buf, key._size);
+  putWord64(buf, key._mtime);
+  putWord64(buf, key._hash);
+  buf.push_back(0);   // number of payload words
+  putWord64(buf, 0);  // and their hash
+
+  buf.push_back(_header.size());
+  for (size_t i = 0; i < _header.size(); i++) putStr(buf, _header[i]);
+
+  buf.push_back(_map.size());
+  for (map<unsigned, CirGate*>::const_iterator it = _map.begin();
+       it != _map.end(); ++it) {
+    const CirGate* g = it->second;
+    buf.push_back(it->first);
+    buf.push_back(g->_id);
+    buf.push_back(g->_type);
+    buf.push_back(g->_lineNo);
+    putStr(buf, g->_name);
+  }
+  for (map<unsigned, CirGate*>::const_iterator it = _map.begin();
+       it != _map.end(); ++it) {
+    const CirGate* g = it->second;
+    buf.push_back(g->_fanin.size());
+    for (size_t j = 0; j < g->_fanin.size(); j++) {
+      GateIndex::iterator f = index.find(g->_fanin[j]);
+      if (f == index.end()) return;
+      buf.push_back(f->second * 2 + g->_invert[j]);
+    }
+  }
+  for (map<unsigned, CirGate*>::const_iterator it = _map.begin();
+       it != _map.end(); ++it) {
+    const CirGate* g = it->second;
+    buf.push_back(g->_fanout.size());
+    for (size_t j = 0; j < g->_fanout.size(); j++) {
+      GateIndex::iterator f = index.find(g->_fanout[j]);
+      if (f == index.end()) return;
+      buf.push_back(f->second);
+    }
+  }
+  const GateList* lists[4] = { &_pi, &_po, &_aig, &getDfsList() };
+  for (size_t k = 0; k < 4; k++) {
+    buf.push_back(lists[k]->size());
+    for (size_t i = 0; i < lists[k]->size(); i++) {
+      GateIndex::iterator f = index.find((*lists[k])[i]);
+      if (f == index.end()) return;
+      buf.push_back(f->second);
+    }
+  }
+  buf[CACHE_HEADER - 3] = buf.size() - CACHE_HEADER;
+  const uint64_t payload = hashBytes((const char*)&buf[CACHE_HEADER],
+                                     4 * (buf.size() - CACHE_HEADER));
+  buf[CACHE_HEADER - 2] = unsigned(payload);
+  buf[CACHE_HEADER - 1] = unsigned(payload >> 32);
+
+  const string cacheName = cacheFileName(fileName);
+  const string tmpName = cacheName + "." + to_string(getpid());
+  FILE* fp = fopen(tmpName.c_str(), "wb");
+  if (!fp) return;
+  bool ok = fwrite(&buf[0], 4, buf.size(), fp) == buf.size();
+  ok = (fclose(fp) == 0) && ok;
+  if (!ok || rename(tmpName.c_str(), cacheName.c_str()) != 0)
+    remove(tmpName.c_str());
+}
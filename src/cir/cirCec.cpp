@@ -0,0 +1,457 @@
+/****************************************************************************
+  FileName     [ cirCec.cpp ]
+  PackageName  [ cir ]
+  Synopsis     [ Define combinational equivalence checking ]
+  Author       [ Chung-Yang (Ric) Huang ]
+  Copyright    [ Copyleft(c) 2008-present LaDs(III), GIEE, NTU, Taiwan ]
+****************************************************************************/
+
+#include <iostream>
+#include <cassert>
+#include <climits>
+#include <algorithm>
+#include "cirMgr.h"
+#include "cirGate.h"
+#include "cirSat.h"
+#include "util.h"
+
+using namespace std;
+
+/**************************************/
+/*   Static varaibles and functions   */
+/**************************************/
+#define CEC_SIM_WORDS     8
+#define CEC_SWEEP_LIMIT   100    // conflicts per internal check
+
+static uint64_t
+randomWord()
+{
+   return (uint64_t(rnGen(INT_MAX)) << 42) ^ (uint64_t(rnGen(INT_MAX)) << 21) ^
+          uint64_t(rnGen(INT_MAX));
+}
+
+// The miter of two circuits as one structurally hashed AIG, swept for
+// internal equivalences before the outputs are compared.  Candidates come
+// from random simulation; the counterexamples found by SAT are simulated
+// back 64 at a time to refine the candidate classes, and the nodes they
+// disproved are checked again after that.  A proven node is substituted
+// by its class representative in the CNF of the later nodes.
+class CirCec
+{
+public:
+   CirCec(unsigned nPi);
+
+   void addCircuit(const CirMgr*, const vector<unsigned>& piIdx,
+                   vector<unsigned>& poLit);
+   void sweep();
+   // return true if equivalent; otherwise fill in the counterexample
+   bool proveOutput(unsigned a, unsigned b, vector<bool>& cex);
+
+   unsigned getProven() const { return _nProven; }
+   unsigned getDisproved() const { return _nDisproved; }
+   unsigned getUndecided() const { return _nUndecided; }
+
+private:
+   unsigned                            _nPi;   // node 1.._nPi are the PIs
+   vector<unsigned>                    _fanin0;  // literals of node
+   vector<unsigned>                    _fanin1;
+   unordered_map<uint64_t, unsigned>   _strash;
+   // simulation and candidate classes
+   vector<uint64_t>                    _sim;     // CEC_SIM_WORDS per node
+   vector<char>                        _phase;
+   vector<int>                         _classOf;
+   vector<vector<unsigned> >           _classes;
+   // sweeping
+   vector<unsigned>                    _repr;    // literal of the merged node
+   SatSolver                           _sat;
+   vector<int>                         _satVar;
+   vector<unsigned>                    _mark;
+   unsigned                            _travId;
+   vector<SatVar>                      _cone;
+   vector<uint64_t>                    _cexWord;   // pending patterns
+   unsigned                            _nCex;
+   // (node, representative) disproved by the pending patterns
+   vector<pair<unsigned, unsigned> >   _retry;
+   unsigned                            _nProven;
+   unsigned                            _nDisproved;
+   unsigned                            _nUndecided;
+
+   bool isAnd(unsigned n) const { return n > _nPi; }
+   unsigned resolve(unsigned lit) const { return _repr[lit / 2] ^ (lit & 1); }
+   unsigned andLit(unsigned a, unsigned b);
+   void simulate(const vector<uint64_t>& pi, vector<uint64_t>& val) const;
+   void initClasses();
+   void splitClass(size_t c, const vector<uint64_t>& val);
+   void removeFromClass(unsigned n);
+   SatVar satVar(unsigned n);
+   void collectCone(unsigned a, unsigned b);
+   SatResult prove(unsigned a, unsigned b, unsigned confLimit);
+   void getCex(vector<bool>& cex, bool randomFill) const;
+   void addCex(const vector<bool>& cex);
+   void refineWithCex();
+   void sweepNode(unsigned n);
+};
+
+CirCec::CirCec(unsigned nPi)
+   : _nPi(nPi), _fanin0(nPi + 1, 0), _fanin1(nPi + 1, 0),
+     _travId(0), _cexWord(nPi, 0), _nCex(0), _nProven(0), _nDisproved(0), _nUndecided(0)
+{
+}
+
+unsigned
+CirCec::andLit(unsigned a, unsigned b)
+{
+   if (a == 0 || b == 0 || a == (b ^ 1)) return 0;
+   if (a == 1 || a == b) return b;
+   if (b == 1) return a;
+   if (a > b) swap(a, b);
+   const uint64_t key = (uint64_t(a) << 32) | b;
+   unordered_map<uint64_t, unsigned>::iterator it = _strash.find(key);
+   if (it != _strash.end()) return it->second * 2;
+   const unsigned n = _fanin0.size();
+   _fanin0.push_back(a);
+   _fanin1.push_back(b);
+   _strash[key] = n;
+   return n * 2;
+}
+
+// piIdx[i] is the miter PI of PI i of the circuit; floating gates are 0
+void
+CirCec::addCircuit(const CirMgr* mgr, const vector<unsigned>& piIdx,
+                   vector<unsigned>& poLit)
+{
+   vector<unsigned> lit(mgr->getGateIdEnd(), 0);
+   const GateList& pi = mgr->getPIs();
+   for (size_t i = 0; i < pi.size(); ++i)
+      lit[pi[i]->_id] = (piIdx[i] + 1) * 2;
+   const GateList& dfsTl = mgr->getDfsList();
+   for (size_t i = 0; i < dfsTl.size(); ++i) {
+      const CirGate* g = dfsTl[i];
+      if (g->_type != AIG_GATE) continue;
+      lit[g->_id] = andLit(lit[g->_fanin[0]->_id] ^ g->_invert[0],
+                           lit[g->_fanin[1]->_id] ^ g->_invert[1]);
+   }
+   const GateList& po = mgr->getPOs();
+   poLit.resize(po.size());
+   for (size_t i = 0; i < po.size(); ++i)
+      poLit[i] = lit[po[i]->_fanin[0]->_id] ^ po[i]->_invert[0];
+}
+
+// One word of simulation of every node
+void
+CirCec::simulate(const vector<uint64_t>& pi, vector<uint64_t>& val) const
+{
+   MY_PERF_SCOPE(perf, "sim");
+   MY_PERF_GATES(perf, _fanin0.size());
+   val.resize(_fanin0.size());
+   val[0] = 0;
+   for (unsigned i = 0; i < _nPi; ++i) val[i + 1] = pi[i];
+   for (size_t n = _nPi + 1; n < _fanin0.size(); ++n) {
+      const unsigned a = _fanin0[n], b = _fanin1[n];
+      val[n] = (val[a / 2] ^ (0 - uint64_t(a & 1))) &
+               (val[b / 2] ^ (0 - uint64_t(b & 1)));
+   }
+}
+
+// Group the nodes by their signatures up to complementation
+void
+CirCec::initClasses()
+{
+   const size_t nNodes = _fanin0.size();
+   _sim.resize(nNodes * CEC_SIM_WORDS);
+   vector<uint64_t> pi(_nPi), val;
+   for (unsigned w = 0; w < CEC_SIM_WORDS; ++w) {
+      for (unsigned i = 0; i < _nPi; ++i) pi[i] = randomWord();
+      simulate(pi, val);
+      for (size_t n = 0; n < nNodes; ++n) _sim[n * CEC_SIM_WORDS + w] = val[n];
+   }
+   _phase.resize(nNodes);
+   unordered_map<uint64_t, vector<unsigned> > buckets;
+   for (size_t n = 0; n < nNodes; ++n) {
+      const uint64_t* s = &_sim[n * CEC_SIM_WORDS];
+      _phase[n] = s[0] & 1;
+      const uint64_t mask = 0 - uint64_t(_phase[n]);
+      uint64_t h = 0;
+      for (unsigned w = 0; w < CEC_SIM_WORDS; ++w)
+         h = (h ^ (s[w] ^ mask)) * 0x9E3779B97F4A7C15ULL;
+      buckets[h].push_back(n);
+   }
+   _classOf.assign(nNodes, -1);
+   _classes.clear();
+   for (unordered_map<uint64_t, vector<unsigned> >::iterator it =
+        buckets.begin(); it != buckets.end(); ++it) {
+      vector<unsigned>& b = it->second;
+      // a hash collision is split later like a false candidate
+      if (b.size() < 2) continue;
+      sort(b.begin(), b.end());
+      for (size_t i = 0; i < b.size(); ++i) _classOf[b[i]] = _classes.size();
+      _classes.push_back(vector<unsigned>());
+      _classes.back().swap(b);
+   }
+}
+
+// Split class c by one more word of simulation; the members that differ
+// from the representative form a new class, split in turn by the caller
+void
+CirCec::splitClass(size_t c, const vector<uint64_t>& val)
+{
+   if (_classes[c].size() < 2) return;
+   vector<unsigned> rest;
+   vector<unsigned>& cls = _classes[c];
+   const uint64_t v0 = val[cls[0]] ^ (0 - uint64_t(_phase[cls[0]]));
+   size_t j = 1;
+   for (size_t i = 1; i < cls.size(); ++i) {
+      if ((val[cls[i]] ^ (0 - uint64_t(_phase[cls[i]]))) == v0)
+         cls[j++] = cls[i];
+      else rest.push_back(cls[i]);
+   }
+   cls.resize(j);
+   if (cls.size() < 2) { _classOf[cls[0]] = -1; cls.clear(); }
+   if (rest.size() < 2) {
+      if (rest.size() == 1) _classOf[rest[0]] = -1;
+      return;
+   }
+   for (size_t i = 0; i < rest.size(); ++i) _classOf[rest[i]] = _classes.size();
+   _classes.push_back(rest);
+}
+
+void
+CirCec::removeFromClass(unsigned n)
+{
+   if (_classOf[n] < 0) return;
+   vector<unsigned>& cls = _classes[_classOf[n]];
+   cls.erase(find(cls.begin(), cls.end(), n));
+   _classOf[n] = -1;
+   if (cls.size() == 1) { _classOf[cls[0]] = -1; cls.clear(); }
+}
+
+// Encode the cone of node n on demand, through the merged nodes
+SatVar
+CirCec::satVar(unsigned n)
+{
+   vector<unsigned> stack(1, n);
+   while (!stack.empty()) {
+      const unsigned t = stack.back();
+      if (_satVar[t] >= 0) { stack.pop_back(); continue; }
+      if (!isAnd(t)) {
+         _satVar[t] = _sat.newVar();
+         if (t == 0) {
+            vector<SatLit> unit(1, satLit(_satVar[t], true));
+            _sat.addClause(unit);
+         }
+         stack.pop_back();
+         continue;
+      }
+      const unsigned a = resolve(_fanin0[t]), b = resolve(_fanin1[t]);
+      if (_satVar[a / 2] < 0) { stack.push_back(a / 2); continue; }
+      if (_satVar[b / 2] < 0) { stack.push_back(b / 2); continue; }
+      _satVar[t] = _sat.newVar();
+      _sat.addAigCNF(_satVar[t], _satVar[a / 2], a & 1, _satVar[b / 2], b & 1);
+      stack.pop_back();
+   }
+   return _satVar[n];
+}
+
+// The solver branches on the encoded cones of nodes a and b only; the
+// merged nodes in the CNF follow their representatives by propagation
+void
+CirCec::collectCone(unsigned a, unsigned b)
+{
+   ++_travId;
+   _cone.clear();
+   vector<unsigned> stack;
+   stack.push_back(a); stack.push_back(b);
+   while (!stack.empty()) {
+      const unsigned t = stack.back();
+      stack.pop_back();
+      if (_mark[t] == _travId) continue;
+      _mark[t] = _travId;
+      assert(_satVar[t] >= 0);
+      _cone.push_back(_satVar[t]);
+      if (!isAnd(t)) continue;
+      stack.push_back(resolve(_fanin0[t]) / 2);
+      stack.push_back(resolve(_fanin1[t]) / 2);
+   }
+   _sat.setDecisionVars(_cone);
+}
+
+// Prove literal a == literal b
+SatResult
+CirCec::prove(unsigned a, unsigned b, unsigned confLimit)
+{
+   const SatVar va = satVar(a / 2), vb = satVar(b / 2);
+   collectCone(a / 2, b / 2);
+   const bool inv = (a ^ b) & 1;
+   for (unsigned val = 0; val < 2; ++val) {
+      _sat.assumeRelease();
+      _sat.assumeProperty(va, val);
+      _sat.assumeProperty(vb, !val ^ inv);
+      const SatResult r = _sat.assumpSolve(confLimit);
+      if (r != SAT_UNSAT) return r;
+   }
+   _sat.addEqCNF(va, vb, inv);
+   return SAT_UNSAT;
+}
+
+// The PI values of the last satisfying assignment; the PIs out of the
+// encoded cones are either random or 0
+void
+CirCec::getCex(vector<bool>& cex, bool randomFill) const
+{
+   cex.resize(_nPi);
+   for (unsigned i = 0; i < _nPi; ++i) {
+      const int v = _satVar[i + 1] < 0 ? -1 : _sat.getValue(_satVar[i + 1]);
+      if (v >= 0) cex[i] = v;
+      else cex[i] = randomFill ? rnGen(2) & 1 : false;
+   }
+}
+
+// The counterexample is bit _nCex of the pending patterns
+void
+CirCec::addCex(const vector<bool>& cex)
+{
+   const uint64_t bit = 1ULL << _nCex;
+   for (unsigned i = 0; i < _nPi; ++i) if (cex[i]) _cexWord[i] |= bit;
+   if (++_nCex == 64) refineWithCex();
+}
+
+// Split every class by the pending patterns in one simulation
+void
+CirCec::refineWithCex()
+{
+   if (!_nCex) return;
+   vector<uint64_t> val;
+   simulate(_cexWord, val);
+   for (size_t c = 0; c < _classes.size(); ++c) splitClass(c, val);
+   _cexWord.assign(_nPi, 0);
+   _nCex = 0;
+}
+
+// Prove node n against its representative until it is merged or out of
+// its class; a disproved node waits for its counterexample to be simulated
+void
+CirCec::sweepNode(unsigned n)
+{
+   vector<bool> cex;
+   while (_classOf[n] >= 0) {
+      const unsigned r = _classes[_classOf[n]][0];
+      if (r == n) return;
+      const unsigned rLit = r * 2 + (_phase[n] ^ _phase[r]);
+      const SatResult res = prove(n * 2, rLit, CEC_SWEEP_LIMIT);
+      if (res == SAT_SAT) {
+         ++_nDisproved;
+         getCex(cex, true);
+         _retry.push_back(make_pair(n, r));
+         addCex(cex);
+         return;
+      }
+      if (res == SAT_UNSAT) { _repr[n] = rLit; ++_nProven; }
+      else ++_nUndecided;
+      removeFromClass(n);
+   }
+}
+
+void
+CirCec::sweep()
+{
+   const size_t nNodes = _fanin0.size();
+   _repr.resize(nNodes);
+   for (size_t n = 0; n < nNodes; ++n) _repr[n] = n * 2;
+   _satVar.assign(nNodes, -1);
+   _mark.assign(nNodes, 0);
+   initClasses();
+
+   for (size_t n = _nPi + 1; n < nNodes; ++n) sweepNode(n);
+   while (!_retry.empty()) {
+      refineWithCex();
+      vector<pair<unsigned, unsigned> > retry;
+      retry.swap(_retry);
+      for (size_t i = 0; i < retry.size(); ++i) {
+         const unsigned n = retry[i].first;
+         // never keep checking a pair the pattern does not tell apart
+         if (_classOf[n] >= 0 && _classes[_classOf[n]][0] == retry[i].second)
+            removeFromClass(n);
+         sweepNode(n);
+      }
+   }
+}
+
+bool
+CirCec::proveOutput(unsigned a, unsigned b, vector<bool>& cex)
+{
+   a = resolve(a); b = resolve(b);
+   if (a == b) return true;
+   if (prove(a, b, 0) == SAT_UNSAT) return true;
+   getCex(cex, false);
+   return false;
+}
+
+/**************************************************************/
+/*   class CirMgr member functions for equivalence checking   */
+/**************************************************************/
+// Pair the I/Os by name if all of them are named alike in both circuits,
+// or by index otherwise
+void
+CirMgr::cec(const CirMgr& other) const
+{
+  const GateList& pi2 = other.getPIs();
+  const GateList& po2 = other.getPOs();
+  if (_pi.size() != pi2.size() || _po.size() != po2.size()) {
+    cerr << "Error: the circuits have different numbers of PIs or POs!!"
+         << endl;
+    return;
+  }
+  vector<unsigned> piIdx(_pi.size()), poIdx(_po.size());
+  bool byName = true;
+  map<string, unsigned> piName, poName;
+  for (size_t i = 0; i < _pi.size() && byName; i++)
+    byName = _pi[i]->_name != "" && piName.insert(make_pair(_pi[i]->_name, i)).second;
+  for (size_t i = 0; i < _po.size() && byName; i++)
+    byName = _po[i]->_name != "" && poName.insert(make_pair(_po[i]->_name, i)).second;
+  for (size_t i = 0; i < pi2.size() && byName; i++) {
+    map<string, unsigned>::iterator it = piName.find(pi2[i]->_name);
+    if (it == piName.end()) byName = false;
+    else { piIdx[i] = it->second; piName.erase(it); }
+  }
+  for (size_t i = 0; i < po2.size() && byName; i++) {
+    map<string, unsigned>::iterator it = poName.find(po2[i]->_name);
+    if (it == poName.end()) byName = false;
+    else { poIdx[i] = it->second; poName.erase(it); }
+  }
+  if (!byName)
+    for (size_t i = 0; i < _pi.size(); i++) piIdx[i] = i;
+  cout << "CEC: " << _pi.size() << " PI(s) and " << _po.size()
+       << " PO(s) matched by " << (byName ? "name" : "index") << endl;
+
+  CirCec miter(_pi.size());
+  vector<unsigned> identity(_pi.size()), lit1, lit2;
+  for (size_t i = 0; i < _pi.size(); i++) identity[i] = i;
+  miter.addCircuit(this, identity, lit1);
+  miter.addCircuit(&other, piIdx, lit2);
+  miter.sweep();
+  cout << "CEC: " << miter.getProven() << " internal equivalence(s) proven, "
+       << miter.getDisproved() << " disproved, " << miter.getUndecided()
+       << " undecided" << endl;
+
+  vector<unsigned> lit2ByPo(_po.size());
+  for (size_t i = 0; i < po2.size(); i++)
+    lit2ByPo[byName ? poIdx[i] : i] = lit2[i];
+  unsigned nDiff = 0;
+  vector<bool> cex;
+  for (size_t i = 0; i < _po.size(); i++) {
+    cout << "PO " << i;
+    if (_po[i]->_name != "") cout << " (" << _po[i]->_name << ")";
+    if (miter.proveOutput(lit1[i], lit2ByPo[i], cex))
+      cout << ": equivalent" << endl;
+    else {
+      ++nDiff;
+      cout << ": NOT equivalent, counterexample ";
+      for (size_t j = 0; j < cex.size(); j++) cout << cex[j];
+      cout << endl;
+    }
+  }
+  if (nDiff)
+    cout << "==> Circuits are NOT equivalent (" << nDiff << " of "
+         << _po.size() << " PO(s) differ)" << endl;
+  else cout << "==> Circuits are equivalent" << endl;
+}
@@ -7,24 +7,83 @@
 ****************************************************************************/
 
 #include <cassert>
+#include <cerrno>
 #include <iostream>
 #include <iomanip>
+#include <fstream>
+#include <sstream>
+#include <iterator>
+#include <thread>
+#include <glob.h>
+#include <poll.h>
+#include <unistd.h>
+#include <sys/wait.h>
 #include "cirMgr.h"
 #include "cirGate.h"
+#include "cirCut.h"
 #include "cirCmd.h"
+#include "cirGen.h"
 #include "util.h"
 
 using namespace std;
 
 extern CirMgr* cirMgr;
+extern CmdExecStatus runBatch(istream& is, unsigned depth, bool& failed);
+
+// Forwards the dispatches to a command and, while CIRPROFile is on,
+// records their run time and memory usage under the command name
+class CirProfiledCmd: public CmdExec
+{
+public:
+   CirProfiledCmd(const string& name, CmdExec* cmd): _name(name), _cmd(cmd) {}
+   ~CirProfiledCmd() { delete _cmd; }
+
+   CmdExecStatus exec(const string& option) {
+      _cmd->setOptCmd(getOptCmd());
+      if (!myProfiler.isOn()) return _cmd->exec(option);
+      MyProfiler::Sample b, e;
+      MyProfiler::sample(b);
+      CmdExecStatus status = _cmd->exec(option);
+      MyProfiler::sample(e);
+      myProfiler.add(_name, b, e);
+      return status;
+   }
+   void usage(ostream& os) const { _cmd->usage(os); }
+   void help() const { _cmd->help(); }
+
+private:
+   string     _name;
+   CmdExec*   _cmd;
+};
+
+static bool
+regCirCmd(const string& name, unsigned nMand, CmdExec* cmd)
+{
+   return cmdMgr->regCmd(name, nMand, new CirProfiledCmd(name, cmd));
+}
 
 bool
 initCirCmd()
 {
-   if (!(cmdMgr->regCmd("CIRRead", 4, new CirReadCmd) &&
-         cmdMgr->regCmd("CIRPrint", 4, new CirPrintCmd) &&
-         cmdMgr->regCmd("CIRGate", 4, new CirGateCmd) &&
-         cmdMgr->regCmd("CIRWrite", 4, new CirWriteCmd)
+   if (!(regCirCmd("CIRRead", 4, new CirReadCmd) &&
+         regCirCmd("CIRPrint", 4, new CirPrintCmd) &&
+         regCirCmd("CIRGate", 4, new CirGateCmd) &&
+         regCirCmd("CIRWrite", 4, new CirWriteCmd) &&
+         regCirCmd("CIRREWrite", 6, new CirRewriteCmd) &&
+         regCirCmd("CIRBalance", 4, new CirBalanceCmd) &&
+         regCirCmd("CIRMap", 4, new CirMapCmd) &&
+         regCirCmd("CIRCEC", 6, new CirCecCmd) &&
+         regCirCmd("CIRSWitch", 5, new CirSwitchCmd) &&
+         regCirCmd("CIRList", 4, new CirListCmd) &&
+         regCirCmd("CIRSNapshot", 5, new CirSnapshotCmd) &&
+         regCirCmd("CIRRESTore", 6, new CirRestoreCmd) &&
+         regCirCmd("CIRExtract", 4, new CirExtractCmd) &&
+         regCirCmd("CIRGENerate", 6, new CirGenerateCmd) &&
+         regCirCmd("CIRPROFile", 7, new CirProfileCmd) &&
+         regCirCmd("CIRBATch", 6, new CirBatchCmd) &&
+         regCirCmd("CIRTiming", 4, new CirTimingCmd) &&
+         regCirCmd("CIRPOwer", 5, new CirPowerCmd) &&
+         regCirCmd("CIRFault", 4, new CirFaultCmd)
       )) {
       cerr << "Registering \"cir\" commands fails... exiting" << endl;
       return false;
@@ -43,9 +102,21 @@ enum CirCmdState
 
 static CirCmdState curCmd = CIRINIT;
 
+// The name of the current design
+static string
+curDesignName()
+{
+   for (map<string, CirMgr*>::iterator it = cirWorkspace.begin();
+        it != cirWorkspace.end(); ++it)
+      if (it->second == cirMgr) return it->first;
+   return "";
+}
+
 //----------------------------------------------------------------------
-//    CIRRead <(string fileName)> [-Replace]
+//    CIRRead <(string fileName)> [-Replace] [-Name (string designName)]
 //----------------------------------------------------------------------
+// Without -Name, the current design is read (again); a new design is
+// named after its file
 CmdExecStatus
 CirReadCmd::exec(const string& option)
 {
@@ -56,38 +127,53 @@ CirReadCmd::exec(const string& option)
    if (options.empty())
       return CmdExec::errorOption(CMD_OPT_MISSING, "");
 
-   bool doReplace = false;
-   string fileName;
+   bool doReplace = false, doName = false;
+   string fileName, name;
    for (size_t i = 0, n = options.size(); i < n; ++i) {
       if (myStrNCmp("-Replace", options[i], 2) == 0) {
          if (doReplace) return CmdExec::errorOption(CMD_OPT_EXTRA,options[i]);
          doReplace = true;
       }
+      else if (myStrNCmp("-Name", options[i], 2) == 0) {
+         if (doName) return CmdExec::errorOption(CMD_OPT_EXTRA,options[i]);
+         if (++i == n)
+            return CmdExec::errorOption(CMD_OPT_MISSING, options[i - 1]);
+         name = options[i];
+         doName = true;
+      }
       else {
          if (fileName.size())
             return CmdExec::errorOption(CMD_OPT_ILLEGAL, options[i]);
          fileName = options[i];
       }
    }
-
-   if (cirMgr != 0) {
-      if (doReplace) {
-         cerr << "Note: original circuit is replaced..." << endl;
-         curCmd = CIRINIT;
-         delete cirMgr; cirMgr = 0;
-      }
+   if (fileName.empty())
+      return CmdExec::errorOption(CMD_OPT_MISSING, "");
+   if (!doName) {
+      if (cirMgr != 0) name = curDesignName();
       else {
-         cerr << "Error: circuit already exists!!" << endl;
-         return CMD_EXEC_ERROR;
+         size_t b = fileName.find_last_of('/');
+         name = fileName.substr(b == string::npos ? 0 : b + 1);
+         name = name.substr(0, name.find_last_of('.'));
       }
    }
-   cirMgr = new CirMgr;
 
-   if (!cirMgr->readCircuit(fileName)) {
-      curCmd = CIRINIT;
-      delete cirMgr; cirMgr = 0;
+   map<string, CirMgr*>::iterator it = cirWorkspace.find(name);
+   if (it != cirWorkspace.end() && !doReplace) {
+      cerr << "Error: circuit already exists!!" << endl;
+      return CMD_EXEC_ERROR;
+   }
+   // the replaced design is kept if the new one cannot be read
+   CirMgr* mgr = new CirMgr;
+   if (!mgr->readCircuit(fileName)) {
+      delete mgr;
       return CMD_EXEC_ERROR;
    }
+   if (it != cirWorkspace.end()) {
+      cerr << "Note: original circuit is replaced..." << endl;
+      delete it->second;
+   }
+   cirWorkspace[name] = cirMgr = mgr;
 
    curCmd = CIRREAD;
 
@@ -97,7 +183,8 @@ CirReadCmd::exec(const string& option)
 void
 CirReadCmd::usage(ostream& os) const
 {
-   os << "Usage: CIRRead <(string fileName)> [-Replace]" << endl;
+   os << "Usage: CIRRead <(string fileName)> [-Replace] "
+      << "[-Name (string designName)]" << endl;
 }
 
 void
@@ -244,9 +331,29 @@ CirGateCmd::help() const
 }
 
 
+// Parse the PO ids from options[i], until a token that is not a number,
+// and leave i at the last id.  On failure, i is at the token in error (an
+// id that is not a PO, or the first token if it is not a number), or at
+// options.size() if no id is given; the caller reports it.
+static bool
+lexPoIds(const vector<string>& options, size_t& i, IdList& poIds)
+{
+   int id;
+   for (; i < options.size() && myStr2Int(options[i], id); ++i) {
+      const CirGate* g = id < 0 ? 0 : cirMgr->getGate(id);
+      if (!g || g->_type != PO_GATE) return false;
+      poIds.push_back(id);
+   }
+   if (poIds.empty()) return false;
+   --i;
+   return true;
+}
+
 //----------------------------------------------------------------------
-//    CIRWrite [-Output (string aagFile)]
+//    CIRWrite [-Output (string aagFile)] [-Cone <(int poId)>...]
 //----------------------------------------------------------------------
+// With -Cone, only the fanin cones of the POs are written, renumbered as
+// a circuit of their own
 CmdExecStatus
 CirWriteCmd::exec(const string& option)
 {
@@ -258,19 +365,45 @@ CirWriteCmd::exec(const string& option)
    vector<string> options;
    CmdExec::lexOptions(option, options);
 
-   if (options.empty())
-      cirMgr->writeAag(cout);
-   else if (myStrNCmp("-Output", options[0], 2) == 0) {
-      if (options.size() == 1)
-         return CmdExec::errorOption(CMD_OPT_MISSING, options[0]);
-      if (options.size() > 2)
-         return CmdExec::errorOption(CMD_OPT_EXTRA, options[2]);
-      ofstream outfile(options[1].c_str(), ios::out);
+   bool doOutput = false, doCone = false;
+   string fileName;
+   IdList poIds;
+   for (size_t i = 0, n = options.size(); i < n; ++i) {
+      if (myStrNCmp("-Output", options[i], 2) == 0) {
+         if (doOutput) return CmdExec::errorOption(CMD_OPT_EXTRA, options[i]);
+         if (++i == n)
+            return CmdExec::errorOption(CMD_OPT_MISSING, options[i - 1]);
+         fileName = options[i];
+         doOutput = true;
+      }
+      else if (myStrNCmp("-Cone", options[i], 2) == 0) {
+         if (doCone) return CmdExec::errorOption(CMD_OPT_EXTRA, options[i]);
+         if (!lexPoIds(options, ++i, poIds)) {
+            if (i == n)
+               return CmdExec::errorOption(CMD_OPT_MISSING, options[i - 1]);
+            return CmdExec::errorOption(CMD_OPT_ILLEGAL, options[i]);
+         }
+         doCone = true;
+      }
+      else if (i == 0)
+         return CmdExec::errorOption(CMD_OPT_ILLEGAL, options[i]);
+      else return CmdExec::errorOption(CMD_OPT_EXTRA, options[i]);
+   }
+
+   CirMgr cone;
+   const CirMgr* mgr = cirMgr;
+   if (doCone) {
+      cirMgr->extractCone(poIds, cone);
+      mgr = &cone;
+   }
+   if (!doOutput)
+      mgr->writeAag(cout);
+   else {
+      ofstream outfile(fileName.c_str(), ios::out);
       if (!outfile)
-         return CmdExec::errorOption(CMD_OPT_FOPEN_FAIL, options[1]);
-      cirMgr->writeAag(outfile);
+         return CmdExec::errorOption(CMD_OPT_FOPEN_FAIL, fileName);
+      mgr->writeAag(outfile);
    }
-   else return CmdExec::errorOption(CMD_OPT_ILLEGAL, options[0]);
 
    return CMD_EXEC_DONE;
 }
@@ -278,7 +411,8 @@ CirWriteCmd::exec(const string& option)
 void
 CirWriteCmd::usage(ostream& os) const
 {
-   os << "Usage: CIRWrite [-Output (string aagFile)]" << endl;
+   os << "Usage: CIRWrite [-Output (string aagFile)] [-Cone <(int poId)>...]"
+      << endl;
 }
 
 void
@@ -288,3 +422,942 @@ CirWriteCmd::help() const
         << "write the netlist to an ASCII AIG file (.aag)\n";
 }
 
+//----------------------------------------------------------------------
+//    CIRREWrite
+//----------------------------------------------------------------------
+CmdExecStatus
+CirRewriteCmd::exec(const string& option)
+{
+   if (!cirMgr) {
+      cerr << "Error: circuit is not yet constructed!!" << endl;
+      return CMD_EXEC_ERROR;
+   }
+   // check option
+   vector<string> options;
+   if (!CmdExec::lexOptions(option, options))
+      return CMD_EXEC_ERROR;
+   if (!options.empty())
+      return CmdExec::errorOption(CMD_OPT_EXTRA, options[0]);
+
+   cirMgr->rewrite();
+
+   return CMD_EXEC_DONE;
+}
+
+void
+CirRewriteCmd::usage(ostream& os) const
+{
+   os << "Usage: CIRREWrite" << endl;
+}
+
+void
+CirRewriteCmd::help() const
+{
+   cout << setw(15) << left << "CIRREWrite: "
+        << "rewrite 4-input cuts with their smallest NPN structures\n";
+}
+
+//----------------------------------------------------------------------
+//    CIRBalance
+//----------------------------------------------------------------------
+CmdExecStatus
+CirBalanceCmd::exec(const string& option)
+{
+   if (!cirMgr) {
+      cerr << "Error: circuit is not yet constructed!!" << endl;
+      return CMD_EXEC_ERROR;
+   }
+   // check option
+   vector<string> options;
+   if (!CmdExec::lexOptions(option, options))
+      return CMD_EXEC_ERROR;
+   if (!options.empty())
+      return CmdExec::errorOption(CMD_OPT_EXTRA, options[0]);
+
+   cirMgr->balance();
+
+   return CMD_EXEC_DONE;
+}
+
+void
+CirBalanceCmd::usage(ostream& os) const
+{
+   os << "Usage: CIRBalance" << endl;
+}
+
+void
+CirBalanceCmd::help() const
+{
+   cout << setw(15) << left << "CIRBalance: "
+        << "rebuild AND supergates as minimum-depth trees\n";
+}
+
+//----------------------------------------------------------------------
+//    CIRMap [-K (int k)] [-Output (string blifFile)]
+//----------------------------------------------------------------------
+CmdExecStatus
+CirMapCmd::exec(const string& option)
+{
+   if (!cirMgr) {
+      cerr << "Error: circuit is not yet constructed!!" << endl;
+      return CMD_EXEC_ERROR;
+   }
+   // check option
+   vector<string> options;
+   if (!CmdExec::lexOptions(option, options))
+      return CMD_EXEC_ERROR;
+
+   int k = 6;
+   string fileName;
+   bool doK = false, doOutput = false;
+   for (size_t i = 0, n = options.size(); i < n; ++i) {
+      if (myStrNCmp("-K", options[i], 2) == 0) {
+         if (doK) return CmdExec::errorOption(CMD_OPT_EXTRA, options[i]);
+         if (++i == n)
+            return CmdExec::errorOption(CMD_OPT_MISSING, options[i - 1]);
+         if (!myStr2Int(options[i], k) || k < 2 || k > CUT_MAX_LEAF)
+            return CmdExec::errorOption(CMD_OPT_ILLEGAL, options[i]);
+         doK = true;
+      }
+      else if (myStrNCmp("-Output", options[i], 2) == 0) {
+         if (doOutput) return CmdExec::errorOption(CMD_OPT_EXTRA, options[i]);
+         if (++i == n)
+            return CmdExec::errorOption(CMD_OPT_MISSING, options[i - 1]);
+         fileName = options[i];
+         doOutput = true;
+      }
+      else return CmdExec::errorOption(CMD_OPT_ILLEGAL, options[i]);
+   }
+
+   if (!doOutput) cirMgr->mapLut(k);
+   else {
+      ofstream outfile(fileName.c_str(), ios::out);
+      if (!outfile)
+         return CmdExec::errorOption(CMD_OPT_FOPEN_FAIL, fileName);
+      cirMgr->mapLut(k, &outfile);
+   }
+
+   return CMD_EXEC_DONE;
+}
+
+void
+CirMapCmd::usage(ostream& os) const
+{
+   os << "Usage: CIRMap [-K (int k)] [-Output (string blifFile)]" << endl;
+}
+
+void
+CirMapCmd::help() const
+{
+   cout << setw(15) << left << "CIRMap: "
+        << "map the circuit to k-input LUTs (default k = 6)\n";
+}
+
+//----------------------------------------------------------------------
+//    CIRCEC <(string design1)> <(string design2)>
+//----------------------------------------------------------------------
+CmdExecStatus
+CirCecCmd::exec(const string& option)
+{
+   // check option
+   vector<string> options;
+   if (!CmdExec::lexOptions(option, options, 2))
+      return CMD_EXEC_ERROR;
+
+   // a resident design is used as is; other names are read as files
+   CirMgr files[2];
+   const CirMgr* mgr[2];
+   for (unsigned i = 0; i < 2; ++i) {
+      map<string, CirMgr*>::iterator it = cirWorkspace.find(options[i]);
+      if (it != cirWorkspace.end()) { mgr[i] = it->second; continue; }
+      if (!files[i].readCircuit(options[i])) {
+         cerr << "Error: cannot read circuit \"" << options[i] << "\"!!"
+              << endl;
+         return CMD_EXEC_ERROR;
+      }
+      mgr[i] = &files[i];
+   }
+   mgr[0]->cec(*mgr[1]);
+
+   return CMD_EXEC_DONE;
+}
+
+void
+CirCecCmd::usage(ostream& os) const
+{
+   os << "Usage: CIRCEC <(string design1)> <(string design2)>" << endl;
+}
+
+void
+CirCecCmd::help() const
+{
+   cout << setw(15) << left << "CIRCEC: "
+        << "check the combinational equivalence of two circuits\n";
+}
+
+//----------------------------------------------------------------------
+//    CIRSWitch <(string designName)>
+//----------------------------------------------------------------------
+CmdExecStatus
+CirSwitchCmd::exec(const string& option)
+{
+   // check option
+   string token;
+   if (!CmdExec::lexSingleOption(option, token, false))
+      return CMD_EXEC_ERROR;
+
+   map<string, CirMgr*>::iterator it = cirWorkspace.find(token);
+   if (it == cirWorkspace.end()) {
+      cerr << "Error: design \"" << token << "\" does not exist!!" << endl;
+      return CMD_EXEC_ERROR;
+   }
+   cirMgr = it->second;
+   curCmd = CIRREAD;
+
+   return CMD_EXEC_DONE;
+}
+
+void
+CirSwitchCmd::usage(ostream& os) const
+{
+   os << "Usage: CIRSWitch <(string designName)>" << endl;
+}
+
+void
+CirSwitchCmd::help() const
+{
+   cout << setw(15) << left << "CIRSWitch: "
+        << "make a resident design the current one\n";
+}
+
+//----------------------------------------------------------------------
+//    CIRList
+//----------------------------------------------------------------------
+CmdExecStatus
+CirListCmd::exec(const string& option)
+{
+   // check option
+   vector<string> options;
+   if (!CmdExec::lexOptions(option, options))
+      return CMD_EXEC_ERROR;
+   if (!options.empty())
+      return CmdExec::errorOption(CMD_OPT_EXTRA, options[0]);
+
+   for (map<string, CirMgr*>::iterator it = cirWorkspace.begin();
+        it != cirWorkspace.end(); ++it) {
+      const CirMgr* mgr = it->second;
+      cout << (mgr == cirMgr ? "* " : "  ") << setw(12) << left << it->first
+           << " PI " << setw(6) << right << mgr->getPIs().size()
+           << "  PO " << setw(6) << right << mgr->getPOs().size()
+           << "  AIG " << setw(8) << right << mgr->getAIGs().size()
+           << "  " << mgr->getFileName() << endl;
+   }
+
+   return CMD_EXEC_DONE;
+}
+
+void
+CirListCmd::usage(ostream& os) const
+{
+   os << "Usage: CIRList" << endl;
+}
+
+void
+CirListCmd::help() const
+{
+   cout << setw(15) << left << "CIRList: "
+        << "list the resident designs\n";
+}
+
+//----------------------------------------------------------------------
+//    CIRSNapshot [(string name) | -List | -Clear]
+//----------------------------------------------------------------------
+CmdExecStatus
+CirSnapshotCmd::exec(const string& option)
+{
+   if (!cirMgr) {
+      cerr << "Error: circuit is not yet constructed!!" << endl;
+      return CMD_EXEC_ERROR;
+   }
+   // check option
+   string token;
+   if (!CmdExec::lexSingleOption(option, token))
+      return CMD_EXEC_ERROR;
+
+   if (myStrNCmp("-List", token, 2) == 0) cirMgr->printSnapshots();
+   else if (myStrNCmp("-Clear", token, 2) == 0) cirMgr->clearSnapshots();
+   else if (token.size() && token[0] == '-')
+      return CmdExec::errorOption(CMD_OPT_ILLEGAL, token);
+   else if (token.size()) {
+      if (!cirMgr->takeSnapshot(token)) {
+         cerr << "Error: snapshot \"" << token << "\" already exists!!"
+              << endl;
+         return CMD_EXEC_ERROR;
+      }
+   }
+   else {
+      // snap<n>, skipping the names in use
+      for (size_t n = cirMgr->getNumSnapshots(); ; ++n) {
+         token = "snap" + to_string(n);
+         if (cirMgr->takeSnapshot(token)) break;
+      }
+      cout << "Snapshot \"" << token << "\" is taken." << endl;
+   }
+
+   return CMD_EXEC_DONE;
+}
+
+void
+CirSnapshotCmd::usage(ostream& os) const
+{
+   os << "Usage: CIRSNapshot [(string name) | -List | -Clear]" << endl;
+}
+
+void
+CirSnapshotCmd::help() const
+{
+   cout << setw(15) << left << "CIRSNapshot: "
+        << "checkpoint the current circuit for CIRRESTore\n";
+}
+
+//----------------------------------------------------------------------
+//    CIRRESTore [(string name)]
+//----------------------------------------------------------------------
+CmdExecStatus
+CirRestoreCmd::exec(const string& option)
+{
+   if (!cirMgr) {
+      cerr << "Error: circuit is not yet constructed!!" << endl;
+      return CMD_EXEC_ERROR;
+   }
+   // check option
+   string token;
+   if (!CmdExec::lexSingleOption(option, token))
+      return CMD_EXEC_ERROR;
+
+   if (!cirMgr->getNumSnapshots()) {
+      cerr << "Error: no snapshot is taken!!" << endl;
+      return CMD_EXEC_ERROR;
+   }
+   if (!cirMgr->restoreSnapshot(token)) {
+      cerr << "Error: snapshot \"" << token << "\" does not exist!!" << endl;
+      return CMD_EXEC_ERROR;
+   }
+
+   return CMD_EXEC_DONE;
+}
+
+void
+CirRestoreCmd::usage(ostream& os) const
+{
+   os << "Usage: CIRRESTore [(string name)]" << endl;
+}
+
+void
+CirRestoreCmd::help() const
+{
+   cout << setw(15) << left << "CIRRESTore: "
+        << "roll the circuit back to a snapshot (default: the latest)\n";
+}
+
+//----------------------------------------------------------------------
+//    CIRExtract <(int poId)>... [-Name (string designName)]
+//----------------------------------------------------------------------
+// The fanin cones of the POs become a new design, which is made the
+// current one; it is named <current design>_cone by default
+CmdExecStatus
+CirExtractCmd::exec(const string& option)
+{
+   if (!cirMgr) {
+      cerr << "Error: circuit is not yet constructed!!" << endl;
+      return CMD_EXEC_ERROR;
+   }
+   // check option
+   vector<string> options;
+   if (!CmdExec::lexOptions(option, options))
+      return CMD_EXEC_ERROR;
+   if (options.empty())
+      return CmdExec::errorOption(CMD_OPT_MISSING, "");
+
+   bool doName = false;
+   string name;
+   IdList poIds;
+   for (size_t i = 0, n = options.size(); i < n; ++i) {
+      if (myStrNCmp("-Name", options[i], 2) == 0) {
+         if (doName) return CmdExec::errorOption(CMD_OPT_EXTRA, options[i]);
+         if (++i == n)
+            return CmdExec::errorOption(CMD_OPT_MISSING, options[i - 1]);
+         name = options[i];
+         doName = true;
+      }
+      else if (poIds.empty()) {
+         if (!lexPoIds(options, i, poIds))
+            return CmdExec::errorOption(CMD_OPT_ILLEGAL, options[i]);
+      }
+      else return CmdExec::errorOption(CMD_OPT_EXTRA, options[i]);
+   }
+   if (poIds.empty())
+      return CmdExec::errorOption(CMD_OPT_MISSING, options.back());
+   if (!doName) name = curDesignName() + "_cone";
+
+   if (cirWorkspace.find(name) != cirWorkspace.end()) {
+      cerr << "Error: circuit already exists!!" << endl;
+      return CMD_EXEC_ERROR;
+   }
+   CirMgr* mgr = new CirMgr;
+   cirMgr->extractCone(poIds, *mgr);
+   cirWorkspace[name] = cirMgr = mgr;
+
+   return CMD_EXEC_DONE;
+}
+
+void
+CirExtractCmd::usage(ostream& os) const
+{
+   os << "Usage: CIRExtract <(int poId)>... [-Name (string designName)]"
+      << endl;
+}
+
+void
+CirExtractCmd::help() const
+{
+   cout << setw(15) << left << "CIRExtract: "
+        << "extract the cones of POs as a new design\n";
+}
+
+//----------------------------------------------------------------------
+//    CIRGENerate [-Output (string aagFile)] [-PI (int n)] [-PO (int n)]
+//                [-AND (int n)] [-Depth (int n)]
+//                [-PRofile <flat | taper | grow>] [-Fanout (double skew)]
+//                [-Redundancy (double rate)] [-Seed (int seed)]
+//----------------------------------------------------------------------
+// The circuit is written as it is generated, without being read in
+static bool
+str2Double(const string& str, double& num)
+{
+   char* end = 0;
+   num = strtod(str.c_str(), &end);
+   return !str.empty() && *end == '\0';
+}
+
+CmdExecStatus
+CirGenerateCmd::exec(const string& option)
+{
+   // check option
+   vector<string> options;
+   if (!CmdExec::lexOptions(option, options))
+      return CMD_EXEC_ERROR;
+
+   CirGenParam param;
+   string fileName;
+   for (size_t i = 0, n = options.size(); i < n; i += 2) {
+      const string& opt = options[i];
+      unsigned* count = 0;
+      double* real = 0;
+      if (myStrNCmp("-PI", opt, 3) == 0) count = &param._nPi;
+      else if (myStrNCmp("-PO", opt, 3) == 0) count = &param._nPo;
+      else if (myStrNCmp("-AND", opt, 2) == 0) count = &param._nAnd;
+      else if (myStrNCmp("-Depth", opt, 2) == 0) count = &param._depth;
+      else if (myStrNCmp("-Seed", opt, 2) == 0) count = &param._seed;
+      else if (myStrNCmp("-Fanout", opt, 2) == 0) real = &param._fanoutSkew;
+      else if (myStrNCmp("-Redundancy", opt, 2) == 0)
+         real = &param._redundancy;
+      else if (myStrNCmp("-Output", opt, 2) != 0 &&
+               myStrNCmp("-PRofile", opt, 3) != 0)
+         return CmdExec::errorOption(CMD_OPT_ILLEGAL, opt);
+      if (i + 1 == n)
+         return CmdExec::errorOption(CMD_OPT_MISSING, opt);
+
+      const string& val = options[i + 1];
+      int num;
+      if (count) {
+         if (!myStr2Int(val, num) || num < 0)
+            return CmdExec::errorOption(CMD_OPT_ILLEGAL, val);
+         *count = num;
+      }
+      else if (real) {
+         if (!str2Double(val, *real))
+            return CmdExec::errorOption(CMD_OPT_ILLEGAL, val);
+      }
+      else if (myStrNCmp("-Output", opt, 2) == 0) fileName = val;
+      else if (myStrNCmp("flat", val, 4) == 0) param._profile = CIR_GEN_FLAT;
+      else if (myStrNCmp("taper", val, 5) == 0) param._profile = CIR_GEN_TAPER;
+      else if (myStrNCmp("grow", val, 4) == 0) param._profile = CIR_GEN_GROW;
+      else return CmdExec::errorOption(CMD_OPT_ILLEGAL, val);
+   }
+
+   CirGenerator gen(param);
+   const string err = gen.check();
+   if (err.size()) {
+      cerr << "Error: " << err << "!!" << endl;
+      return CMD_EXEC_ERROR;
+   }
+   if (fileName.empty()) {
+      gen.generate(cout);
+      return CMD_EXEC_DONE;
+   }
+   ofstream outfile(fileName.c_str(), ios::out);
+   if (!outfile)
+      return CmdExec::errorOption(CMD_OPT_FOPEN_FAIL, fileName);
+   gen.generate(outfile);
+   if (!outfile) {
+      cerr << "Error: writing \"" << fileName << "\" fails!!" << endl;
+      return CMD_EXEC_ERROR;
+   }
+   cout << "Generated \"" << fileName << "\": " << param._nPi << " PI(s), "
+        << param._nPo << " PO(s), " << param._nAnd << " AIG(s) ("
+        << gen.getNumRedundant() << " redundant)" << endl;
+
+   return CMD_EXEC_DONE;
+}
+
+void
+CirGenerateCmd::usage(ostream& os) const
+{
+   os << "Usage: CIRGENerate [-Output (string aagFile)] [-PI (int n)] "
+      << "[-PO (int n)] [-AND (int n)]\n"
+      << "                   [-Depth (int n)] [-PRofile <flat | taper | grow>] "
+      << "[-Fanout (double skew)]\n"
+      << "                   [-Redundancy (double rate)] [-Seed (int seed)]"
+      << endl;
+}
+
+void
+CirGenerateCmd::help() const
+{
+   cout << setw(15) << left << "CIRGENerate: "
+        << "write a random AIG for stress tests\n";
+}
+
+//----------------------------------------------------------------------
+//    CIRPROFile [-ON | -OFF | -Reset | -Print] [-Sort (string key)]
+//----------------------------------------------------------------------
+// While on, every dispatch of a cir command is profiled; the table is
+// printed on -Print (the default) and at exit, followed by the hardware
+// counters of the hot paths in a "make PERF=1" build.  The keys of -Sort are
+// wall, cpu, calls, rss, faults and name.
+static const char* profSortStr[PROF_SORT_TOT] = {
+   "wall", "cpu", "calls", "rss", "faults", "name"
+};
+static MyProfSort profSort = PROF_SORT_WALL;
+
+static void
+printProfileAtExit()
+{
+   MY_PERF_REPORT(cout);
+   if (myProfiler.empty()) return;
+   cout << "Command profile:" << endl;
+   myProfiler.report(cout, profSort);
+}
+
+CmdExecStatus
+CirProfileCmd::exec(const string& option)
+{
+   // check option
+   vector<string> options;
+   if (!CmdExec::lexOptions(option, options))
+      return CMD_EXEC_ERROR;
+
+   enum { PROF_PRINT, PROF_ON, PROF_OFF, PROF_RESET } action = PROF_PRINT;
+   bool doAction = false, doSort = false;
+   for (size_t i = 0, n = options.size(); i < n; ++i) {
+      if (myStrNCmp("-Sort", options[i], 2) == 0) {
+         if (doSort) return CmdExec::errorOption(CMD_OPT_EXTRA, options[i]);
+         if (++i == n)
+            return CmdExec::errorOption(CMD_OPT_MISSING, options[i - 1]);
+         size_t k = 0;
+         while (k < PROF_SORT_TOT &&
+                myStrNCmp(profSortStr[k], options[i], 1) != 0) ++k;
+         if (k == PROF_SORT_TOT)
+            return CmdExec::errorOption(CMD_OPT_ILLEGAL, options[i]);
+         profSort = MyProfSort(k);
+         doSort = true;
+         continue;
+      }
+      if (doAction) return CmdExec::errorOption(CMD_OPT_EXTRA, options[i]);
+      if (myStrNCmp("-ON", options[i], 3) == 0) action = PROF_ON;
+      else if (myStrNCmp("-OFF", options[i], 3) == 0) action = PROF_OFF;
+      else if (myStrNCmp("-Reset", options[i], 2) == 0) action = PROF_RESET;
+      else if (myStrNCmp("-Print", options[i], 2) == 0) action = PROF_PRINT;
+      else return CmdExec::errorOption(CMD_OPT_ILLEGAL, options[i]);
+      doAction = true;
+   }
+
+   static bool atExitSet = false;
+   switch (action) {
+      case PROF_ON:
+         if (!atExitSet) atExitSet = !atexit(printProfileAtExit);
+         myProfiler.enable(true);
+         break;
+      case PROF_OFF: myProfiler.enable(false); break;
+      case PROF_RESET: myProfiler.reset(); MY_PERF_RESET(); break;
+      default:
+         if (myProfiler.empty()) cout << "No command is profiled." << endl;
+         else myProfiler.report(cout, profSort);
+         MY_PERF_REPORT(cout);
+         break;
+   }
+
+   return CMD_EXEC_DONE;
+}
+
+void
+CirProfileCmd::usage(ostream& os) const
+{
+   os << "Usage: CIRPROFile [-ON | -OFF | -Reset | -Print] "
+      << "[-Sort <wall | cpu | calls | rss | faults | name>]" << endl;
+}
+
+void
+CirProfileCmd::help() const
+{
+   cout << setw(15) << left << "CIRPROFile: "
+        << "profile the time and memory of cir commands\n";
+}
+
+//----------------------------------------------------------------------
+//    CIRBATch <(string dofile)> <(string aagGlob)>... [-Jobs (int n)]
+//----------------------------------------------------------------------
+// Every circuit is read and run through the dofile by its own process, so
+// the commands work on an isolated current design as usual; up to -Jobs
+// (default: the number of cores) of them run at a time, each reading its
+// circuit while the others work.  Their outputs are collected and printed
+// in the order of the files.
+struct CirBatchJob
+{
+   CirBatchJob(const string& f): _file(f), _pid(-1), _fd(-1), _status(-1) {}
+
+   string   _file;
+   pid_t    _pid;
+   int      _fd;       // stdout and stderr of the job, until its end
+   string   _out;
+   int      _status;   // exit status once it ends
+};
+
+// Read the circuit and run the dofile on it as in batch mode
+static int
+runBatchJob(const string& file, const string& dofile)
+{
+   cirWorkspace.clear();
+   cirMgr = 0;
+   curCmd = CIRINIT;
+   if (cmdMgr->getCmd("CIRRead")->exec(file) != CMD_EXEC_DONE) {
+      cerr << "Error: cannot read circuit \"" << file << "\"!!" << endl;
+      return 1;
+   }
+   istringstream is(dofile);
+   bool failed = false;
+   runBatch(is, 0, failed);
+   return failed ? 1 : 0;
+}
+
+static bool
+startBatchJob(CirBatchJob& job, const string& dofile)
+{
+   int fd[2];
+   if (pipe(fd) < 0) return false;
+   cout.flush();
+   job._pid = fork();
+   if (job._pid == 0) {
+      close(fd[0]);
+      dup2(fd[1], 1);
+      dup2(fd[1], 2);
+      close(fd[1]);
+      const int status = runBatchJob(job._file, dofile);
+      cout.flush();
+      _exit(status);
+   }
+   close(fd[1]);
+   if (job._pid < 0) {
+      close(fd[0]);
+      return false;
+   }
+   job._fd = fd[0];
+   return true;
+}
+
+CmdExecStatus
+CirBatchCmd::exec(const string& option)
+{
+   // check option
+   vector<string> options;
+   if (!CmdExec::lexOptions(option, options))
+      return CMD_EXEC_ERROR;
+
+   int nJobs = 0;
+   string dofile;
+   vector<string> patterns;
+   for (size_t i = 0, n = options.size(); i < n; ++i) {
+      if (myStrNCmp("-Jobs", options[i], 2) == 0) {
+         if (nJobs) return CmdExec::errorOption(CMD_OPT_EXTRA, options[i]);
+         if (++i == n)
+            return CmdExec::errorOption(CMD_OPT_MISSING, options[i - 1]);
+         if (!myStr2Int(options[i], nJobs) || nJobs <= 0)
+            return CmdExec::errorOption(CMD_OPT_ILLEGAL, options[i]);
+      }
+      else if (dofile.empty()) dofile = options[i];
+      else patterns.push_back(options[i]);
+   }
+   if (dofile.empty()) return CmdExec::errorOption(CMD_OPT_MISSING, "");
+   if (patterns.empty())
+      return CmdExec::errorOption(CMD_OPT_MISSING, dofile);
+   if (!nJobs) nJobs = max(1u, thread::hardware_concurrency());
+
+   ifstream dof(dofile.c_str());
+   if (!dof) return CmdExec::errorOption(CMD_OPT_FOPEN_FAIL, dofile);
+   const string script((istreambuf_iterator<char>(dof)),
+                       istreambuf_iterator<char>());
+
+   vector<CirBatchJob> jobs;
+   for (size_t i = 0; i < patterns.size(); ++i) {
+      // a file name without wildcards is a job even if it does not exist,
+      // and fails to read its circuit
+      const int flags =
+         patterns[i].find_first_of("*?[") == string::npos ? GLOB_NOCHECK : 0;
+      glob_t g;
+      if (glob(patterns[i].c_str(), flags, 0, &g) == 0)
+         for (size_t j = 0; j < g.gl_pathc; ++j)
+            jobs.push_back(CirBatchJob(g.gl_pathv[j]));
+      globfree(&g);
+   }
+   if (jobs.empty()) {
+      cerr << "Error: no circuit matches the patterns!!" << endl;
+      return CMD_EXEC_ERROR;
+   }
+
+   // start jobs in order while fewer than nJobs run; print the finished
+   // ones once all those before them are printed
+   size_t next = 0, printed = 0, nFailed = 0;
+   vector<size_t> running;
+   vector<struct pollfd> fds;
+   char buf[4096];
+   while (printed < jobs.size()) {
+      while (next < jobs.size() && running.size() < size_t(nJobs)) {
+         if (startBatchJob(jobs[next], script)) running.push_back(next);
+         else {
+            jobs[next]._out = "Error: cannot start the job!!\n";
+            jobs[next]._status = 1;
+         }
+         ++next;
+      }
+      fds.resize(running.size());
+      for (size_t k = 0; k < running.size(); ++k) {
+         fds[k].fd = jobs[running[k]]._fd;
+         fds[k].events = POLLIN;
+         fds[k].revents = 0;
+      }
+      if (!fds.empty() && poll(&fds[0], fds.size(), -1) < 0 && errno != EINTR)
+         break;
+      for (size_t k = running.size(); k-- > 0; ) {
+         if (!fds[k].revents) continue;
+         CirBatchJob& job = jobs[running[k]];
+         const ssize_t n = read(job._fd, buf, sizeof(buf));
+         if (n > 0) { job._out.append(buf, n); continue; }
+         if (n < 0 && errno == EINTR) continue;
+         close(job._fd);
+         int status = 0;
+         while (waitpid(job._pid, &status, 0) < 0 && errno == EINTR) ;
+         job._status = WIFEXITED(status) ? WEXITSTATUS(status) : 1;
+         running.erase(running.begin() + k);
+      }
+      for (; printed < jobs.size() && jobs[printed]._status >= 0; ++printed) {
+         const CirBatchJob& job = jobs[printed];
+         cout << "==> " << job._file << " <==" << endl << job._out;
+         if (job._status) ++nFailed;
+         string().swap(jobs[printed]._out);
+      }
+   }
+   cout << "Total " << jobs.size() << " circuit(s), " << nFailed
+        << " failed" << endl;
+
+   return nFailed ? CMD_EXEC_ERROR : CMD_EXEC_DONE;
+}
+
+void
+CirBatchCmd::usage(ostream& os) const
+{
+   os << "Usage: CIRBATch <(string dofile)> <(string aagGlob)>... "
+      << "[-Jobs (int n)]" << endl;
+}
+
+void
+CirBatchCmd::help() const
+{
+   cout << setw(15) << left << "CIRBATch: "
+        << "run a dofile on many circuits in parallel\n";
+}
+
+//----------------------------------------------------------------------
+//    CIRTiming [-Unit] [-PI (double d)] [-AIG (double d)] [-PO (double d)]
+//              [-INV (double d)] [-PAths (int n)] [-Bins (int n)]
+//              [-PEriod (double t)]
+//----------------------------------------------------------------------
+// The delay model is kept for the following calls until -Unit; the timing
+// of the circuit is updated incrementally after netlist editing.
+static CirDelayModel timingModel;
+
+CmdExecStatus
+CirTimingCmd::exec(const string& option)
+{
+   if (!cirMgr) {
+      cerr << "Error: circuit is not yet constructed!!" << endl;
+      return CMD_EXEC_ERROR;
+   }
+   // check option
+   vector<string> options;
+   if (!CmdExec::lexOptions(option, options))
+      return CMD_EXEC_ERROR;
+
+   CirDelayModel model = timingModel;
+   int nPaths = 1, nBins = 10;
+   double period = 0;
+   for (size_t i = 0, n = options.size(); i < n; ++i) {
+      const string& opt = options[i];
+      if (myStrNCmp("-Unit", opt, 2) == 0) {
+         model = CirDelayModel();
+         continue;
+      }
+      double* d = 0;
+      int* k = 0;
+      if (myStrNCmp("-PI", opt, 3) == 0) d = &model._pi;
+      else if (myStrNCmp("-AIG", opt, 2) == 0) d = &model._aig;
+      else if (myStrNCmp("-PO", opt, 3) == 0) d = &model._po;
+      else if (myStrNCmp("-INV", opt, 2) == 0) d = &model._inv;
+      else if (myStrNCmp("-PEriod", opt, 3) == 0) d = &period;
+      else if (myStrNCmp("-PAths", opt, 3) == 0) k = &nPaths;
+      else if (myStrNCmp("-Bins", opt, 2) == 0) k = &nBins;
+      else return CmdExec::errorOption(CMD_OPT_ILLEGAL, opt);
+      if (++i == n) return CmdExec::errorOption(CMD_OPT_MISSING, opt);
+      if (d && (!str2Double(options[i], *d) || *d < 0))
+         return CmdExec::errorOption(CMD_OPT_ILLEGAL, options[i]);
+      if (k && (!myStr2Int(options[i], *k) || *k < 0))
+         return CmdExec::errorOption(CMD_OPT_ILLEGAL, options[i]);
+   }
+
+   timingModel = model;
+   cirMgr->updateTiming(model);
+   cirMgr->reportTiming(nPaths, nBins, period);
+
+   return CMD_EXEC_DONE;
+}
+
+void
+CirTimingCmd::usage(ostream& os) const
+{
+   os << "Usage: CIRTiming [-Unit] [-PI (double d)] [-AIG (double d)] "
+      << "[-PO (double d)] [-INV (double d)]\n"
+      << "                 [-PAths (int n)] [-Bins (int n)] "
+      << "[-PEriod (double t)]" << endl;
+}
+
+void
+CirTimingCmd::help() const
+{
+   cout << setw(15) << left << "CIRTiming: "
+        << "report arrival times, critical paths and slacks\n";
+}
+
+//----------------------------------------------------------------------
+//    CIRPOwer [-Patterns (int n)] [-Seed (int s)] [-Top (int n) | -All]
+//----------------------------------------------------------------------
+CmdExecStatus
+CirPowerCmd::exec(const string& option)
+{
+   if (!cirMgr) {
+      cerr << "Error: circuit is not yet constructed!!" << endl;
+      return CMD_EXEC_ERROR;
+   }
+   // check option
+   vector<string> options;
+   if (!CmdExec::lexOptions(option, options))
+      return CMD_EXEC_ERROR;
+
+   int nPatterns = 65536, seed = 1, nTop = 10;
+   for (size_t i = 0, n = options.size(); i < n; ++i) {
+      const string& opt = options[i];
+      if (myStrNCmp("-All", opt, 2) == 0) {
+         nTop = 0;
+         continue;
+      }
+      int* k = 0;
+      if (myStrNCmp("-Patterns", opt, 2) == 0) k = &nPatterns;
+      else if (myStrNCmp("-Seed", opt, 2) == 0) k = &seed;
+      else if (myStrNCmp("-Top", opt, 2) == 0) k = &nTop;
+      else return CmdExec::errorOption(CMD_OPT_ILLEGAL, opt);
+      if (++i == n) return CmdExec::errorOption(CMD_OPT_MISSING, opt);
+      if (!myStr2Int(options[i], *k) || *k < (k == &seed ? 0 : 1))
+         return CmdExec::errorOption(CMD_OPT_ILLEGAL, options[i]);
+   }
+
+   cirMgr->reportPower(nPatterns, seed, nTop);
+
+   return CMD_EXEC_DONE;
+}
+
+void
+CirPowerCmd::usage(ostream& os) const
+{
+   os << "Usage: CIRPOwer [-Patterns (int n)] [-Seed (int s)] "
+      << "[-Top (int n) | -All]" << endl;
+}
+
+void
+CirPowerCmd::help() const
+{
+   cout << setw(15) << left << "CIRPOwer: "
+        << "estimate signal probabilities and switching activity\n";
+}
+
+//----------------------------------------------------------------------
+//    CIRFault [-Patterns (int n)] [-Seed (int s)] [-Jobs (int n)]
+//             [-Undetected]
+//----------------------------------------------------------------------
+CmdExecStatus
+CirFaultCmd::exec(const string& option)
+{
+   if (!cirMgr) {
+      cerr << "Error: circuit is not yet constructed!!" << endl;
+      return CMD_EXEC_ERROR;
+   }
+   // check option
+   vector<string> options;
+   if (!CmdExec::lexOptions(option, options))
+      return CMD_EXEC_ERROR;
+
+   int nPatterns = 8192, seed = 1, nJobs = 0;
+   bool listUndetected = false;
+   for (size_t i = 0, n = options.size(); i < n; ++i) {
+      const string& opt = options[i];
+      if (myStrNCmp("-Undetected", opt, 2) == 0) {
+         listUndetected = true;
+         continue;
+      }
+      int* k = 0;
+      if (myStrNCmp("-Patterns", opt, 2) == 0) k = &nPatterns;
+      else if (myStrNCmp("-Seed", opt, 2) == 0) k = &seed;
+      else if (myStrNCmp("-Jobs", opt, 2) == 0) k = &nJobs;
+      else return CmdExec::errorOption(CMD_OPT_ILLEGAL, opt);
+      if (++i == n) return CmdExec::errorOption(CMD_OPT_MISSING, opt);
+      if (!myStr2Int(options[i], *k) || *k < (k == &nPatterns ? 1 : 0))
+         return CmdExec::errorOption(CMD_OPT_ILLEGAL, options[i]);
+   }
+   if (!nJobs) nJobs = max(1u, thread::hardware_concurrency());
+
+   cirMgr->faultSim(nPatterns, seed, nJobs, listUndetected);
+
+   return CMD_EXEC_DONE;
+}
+
+void
+CirFaultCmd::usage(ostream& os) const
+{
+   os << "Usage: CIRFault [-Patterns (int n)] [-Seed (int s)] [-Jobs (int n)]"
+      << " [-Undetected]" << endl;
+}
+
+void
+CirFaultCmd::help() const
+{
+   cout << setw(15) << left << "CIRFault: "
+        << "simulate stuck-at faults and report the fault coverage\n";
+}
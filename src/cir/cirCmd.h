@@ -15,5 +15,20 @@ CmdClass(CirReadCmd);
 CmdClass(CirPrintCmd);
 CmdClass(CirGateCmd);
 CmdClass(CirWriteCmd);
+CmdClass(CirRewriteCmd);
+CmdClass(CirBalanceCmd);
+CmdClass(CirMapCmd);
+CmdClass(CirCecCmd);
+CmdClass(CirSwitchCmd);
+CmdClass(CirListCmd);
+CmdClass(CirSnapshotCmd);
+CmdClass(CirRestoreCmd);
+CmdClass(CirExtractCmd);
+CmdClass(CirGenerateCmd);
+CmdClass(CirProfileCmd);
+CmdClass(CirBatchCmd);
+CmdClass(CirTimingCmd);
+CmdClass(CirPowerCmd);
+CmdClass(CirFaultCmd);
 
 #endif // CIR_CMD_H
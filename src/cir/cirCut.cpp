@@ -0,0 +1,308 @@
+/****************************************************************************
+  FileName     [ cirCut.cpp ]
+  PackageName  [ cir ]
+  Synopsis     [ Define k-feasible priority cut enumeration ]
+  Author       [ Chung-Yang (Ric) Huang ]
+  Copyright    [ Copyleft(c) 2008-present LaDs(III), GIEE, NTU, Taiwan ]
+****************************************************************************/
+
+#include <cassert>
+#include <algorithm>
+#include "cirCut.h"
+#include "cirMgr.h"
+#include "cirGate.h"
+#include "util.h"
+
+using namespace std;
+
+/*******************************/
+/*   Global variable and enum  */
+/*******************************/
+const uint64_t _truthVar[CUT_MAX_LEAF] = {
+   0xAAAAAAAAAAAAAAAAULL, 0xCCCCCCCCCCCCCCCCULL, 0xF0F0F0F0F0F0F0F0ULL,
+   0xFF00FF00FF00FF00ULL, 0xFFFF0000FFFF0000ULL, 0xFFFFFFFF00000000ULL
+};
+
+/**************************************/
+/*   Static varaibles and functions   */
+/**************************************/
+static const uint64_t _swapMask[CUT_MAX_LEAF - 1][3] = {
+   { 0x9999999999999999ULL, 0x2222222222222222ULL, 0x4444444444444444ULL },
+   { 0xC3C3C3C3C3C3C3C3ULL, 0x0C0C0C0C0C0C0C0CULL, 0x3030303030303030ULL },
+   { 0xF00FF00FF00FF00FULL, 0x00F000F000F000F0ULL, 0x0F000F000F000F00ULL },
+   { 0xFF0000FFFF0000FFULL, 0x0000FF000000FF00ULL, 0x00FF000000FF0000ULL },
+   { 0xFFFF00000000FFFFULL, 0x00000000FFFF0000ULL, 0x0000FFFF00000000ULL }
+};
+
+static inline uint64_t
+leafSign(unsigned gid)
+{
+   return 1ULL << (gid & 63);
+}
+
+static inline unsigned
+countOnes(uint64_t x)
+{
+   return __builtin_popcountll(x);
+}
+
+uint64_t
+truthSwapAdjacent(uint64_t t, unsigned v)
+{
+   assert(v + 1 < CUT_MAX_LEAF);
+   const unsigned shift = 1u << v;
+   return (t & _swapMask[v][0]) | ((t & _swapMask[v][1]) << shift) |
+          ((t & _swapMask[v][2]) >> shift);
+}
+
+uint64_t
+truthStretch(uint64_t t, const unsigned* from, unsigned nFrom,
+             const unsigned* to, unsigned nTo)
+{
+   // Move the variables up from the last one, so that the positions in
+   // between are always don't-cares of the function
+   int j = int(nTo) - 1;
+   for (int i = int(nFrom) - 1; i >= 0; --i, --j) {
+      while (to[j] != from[i]) { --j; assert(j >= i); }
+      for (int v = i; v < j; ++v)
+         t = truthSwapAdjacent(t, v);
+   }
+   return t;
+}
+
+/**************************************/
+/*   class CirCut member functions    */
+/**************************************/
+bool
+CirCut::dominates(const CirCut& c) const
+{
+   if (_size > c._size || (_sign & ~c._sign)) return false;
+   for (unsigned i = 0, j = 0; i < _size; ++i, ++j) {
+      while (j < c._size && c._leaf[j] < _leaf[i]) ++j;
+      if (j == c._size || c._leaf[j] != _leaf[i]) return false;
+   }
+   return true;
+}
+
+/*****************************************/
+/*   class CirCutMgr member functions    */
+/*****************************************/
+CirCutMgr::CirCutMgr(unsigned k, unsigned nCuts, bool keepAll)
+   : _mgr(0), _k(k), _nCuts(nCuts), _keepAll(keepAll)
+{
+   assert(k >= 2 && k <= CUT_MAX_LEAF);
+   assert(nCuts >= 1);
+}
+
+void
+CirCutMgr::reset()
+{
+   for (size_t i = 0; i < _levelArena.size(); ++i)
+      delete [] _levelArena[i];
+   clearList(_levelArena);
+   clearList(_levelBegin);
+   clearList(_levelLastUse);
+   clearList(_order);
+   clearList(_level);
+   clearList(_slot);
+   clearList(_num);
+   _mgr = 0;
+}
+
+void
+CirCutMgr::enumerate(const CirMgr* mgr)
+{
+   reset();
+   _mgr = mgr;
+   const unsigned nIds = mgr->getGateIdEnd();
+   _level.assign(nIds, 0);
+   _slot.assign(nIds, 0);
+   _num.assign(nIds, 0);
+
+   const GateList& dfsTl = mgr->getDfsList();
+
+   // levelize and bucket the gates by level
+   unsigned maxLevel = 0;
+   for (size_t i = 0, n = dfsTl.size(); i < n; ++i) {
+      CirGate* g = dfsTl[i];
+      if (g->_type != AIG_GATE) continue;
+      unsigned lvl = max(_level[g->_fanin[0]->_id], _level[g->_fanin[1]->_id]);
+      _level[g->_id] = ++lvl;
+      if (lvl > maxLevel) maxLevel = lvl;
+   }
+   _levelBegin.assign(maxLevel + 2, 0);
+   _levelLastUse.assign(maxLevel + 1, 0);
+   for (size_t i = 0, n = dfsTl.size(); i < n; ++i) {
+      CirGate* g = dfsTl[i];
+      if (g->_type == PO_GATE) continue;
+      ++_levelBegin[_level[g->_id] + 1];
+      if (g->_type != AIG_GATE) continue;
+      for (size_t j = 0; j < 2; ++j) {
+         unsigned& use = _levelLastUse[_level[g->_fanin[j]->_id]];
+         if (use < _level[g->_id]) use = _level[g->_id];
+      }
+   }
+   for (unsigned l = 1; l <= maxLevel + 1; ++l)
+      _levelBegin[l] += _levelBegin[l - 1];
+   _order.resize(_levelBegin[maxLevel + 1]);
+   vector<unsigned> fill(_levelBegin.begin(), _levelBegin.end() - 1);
+   for (size_t i = 0, n = dfsTl.size(); i < n; ++i)
+      if (dfsTl[i]->_type != PO_GATE)
+         _order[fill[_level[dfsTl[i]->_id]]++] = dfsTl[i];
+
+   // one arena block per level; sources only have their trivial cut
+   _levelArena.assign(maxLevel + 1, 0);
+   for (unsigned l = 0; l <= maxLevel; ++l) {
+      const unsigned perNode = (l == 0) ? 1 : _nCuts + 1;
+      const unsigned nNodes = _levelBegin[l + 1] - _levelBegin[l];
+      _levelArena[l] = new CirCut[nNodes * perNode];
+      for (unsigned i = 0; i < nNodes; ++i)
+         _slot[_order[_levelBegin[l] + i]->_id] = _levelArena[l] + i * perNode;
+   }
+
+   // the levels whose last fanout is at level l, or that have none above
+   vector<IdList> release(maxLevel + 1);
+   if (!_keepAll)
+      for (unsigned r = 0; r <= maxLevel; ++r)
+         release[max(r, _levelLastUse[r])].push_back(r);
+
+   vector<CirCut> cuts;
+   for (unsigned l = 0; l <= maxLevel; ++l) {
+      for (unsigned i = _levelBegin[l]; i < _levelBegin[l + 1]; ++i) {
+         CirGate* g = _order[i];
+         CirCut* slot = _slot[g->_id];
+         if (g->_type == CONST_GATE) {
+            slot[0] = CirCut();         // no leaf, constant 0
+            _num[g->_id] = 1;
+         }
+         else if (g->_type != AIG_GATE) {
+            slot[0] = CirCut();
+            slot[0]._leaf[0] = g->_id;
+            slot[0]._size = 1;
+            slot[0]._sign = leafSign(g->_id);
+            slot[0]._truth = _truthVar[0];
+            evalCut(g->_id, slot[0]);
+            _num[g->_id] = 1;
+         }
+         else computeCuts(g, slot, cuts);
+         nodeDone(g->_id);
+      }
+      // all fanouts of these levels have got their cuts
+      for (size_t i = 0; i < release[l].size(); ++i)
+         releaseLevel(release[l][i]);
+   }
+}
+
+void
+CirCutMgr::releaseLevel(unsigned lvl)
+{
+   if (lvl >= _levelArena.size() || !_levelArena[lvl]) return;
+   delete [] _levelArena[lvl];
+   _levelArena[lvl] = 0;
+   for (unsigned i = _levelBegin[lvl]; i < _levelBegin[lvl + 1]; ++i) {
+      _slot[_order[i]->_id] = 0;
+      _num[_order[i]->_id] = 0;
+   }
+}
+
+size_t
+CirCutMgr::getTotalCuts() const
+{
+   size_t n = 0;
+   for (size_t i = 0; i < _num.size(); ++i)
+      n += _num[i];
+   return n;
+}
+
+size_t
+CirCutMgr::getMemUsage() const
+{
+   size_t n = 0;
+   for (unsigned l = 0; l < _levelArena.size(); ++l)
+      if (_levelArena[l])
+         n += (_levelBegin[l + 1] - _levelBegin[l]) * (l ? _nCuts + 1 : 1);
+   return n * sizeof(CirCut);
+}
+
+bool
+CirCutMgr::cutLess(const CirCut& a, const CirCut& b) const
+{
+   return a._size < b._size;
+}
+
+void
+CirCutMgr::computeCuts(CirGate* g, CirCut* slot, vector<CirCut>& cuts)
+{
+   const CirGate* a = g->_fanin[0];
+   const CirGate* b = g->_fanin[1];
+   const CirCut* ca = _slot[a->_id];
+   const CirCut* cb = _slot[b->_id];
+   assert(ca && cb);
+   const uint64_t ma = g->_invert[0] ? ~0ULL : 0;
+   const uint64_t mb = g->_invert[1] ? ~0ULL : 0;
+
+   cuts.clear();
+   for (unsigned i = 0, na = _num[a->_id]; i < na; ++i) {
+      for (unsigned j = 0, nb = _num[b->_id]; j < nb; ++j) {
+         CirCut c;
+         if (!mergeCut(ca[i], cb[j], c)) continue;
+         const uint64_t ta = truthStretch(ca[i]._truth, ca[i]._leaf,
+                                          ca[i]._size, c._leaf, c._size);
+         const uint64_t tb = truthStretch(cb[j]._truth, cb[j]._leaf,
+                                          cb[j]._size, c._leaf, c._size);
+         c._truth = (ta ^ ma) & (tb ^ mb);
+         evalCut(g->_id, c);
+         addCut(cuts, c);
+      }
+   }
+   // keep the best _nCuts of them, and the trivial cut at the end
+   stable_sort(cuts.begin(), cuts.end(),
+               [this](const CirCut& x, const CirCut& y) {
+                  return cutLess(x, y); });
+   unsigned n = min(unsigned(cuts.size()), _nCuts);
+   for (unsigned i = 0; i < n; ++i)
+      slot[i] = cuts[i];
+   CirCut& t = slot[n];
+   t = CirCut();
+   t._leaf[0] = g->_id;
+   t._size = 1;
+   t._sign = leafSign(g->_id);
+   t._truth = _truthVar[0];
+   evalCut(g->_id, t);
+   _num[g->_id] = n + 1;
+}
+
+bool
+CirCutMgr::mergeCut(const CirCut& a, const CirCut& b, CirCut& c) const
+{
+   c._sign = a._sign | b._sign;
+   if (countOnes(c._sign) > _k) return false;
+   unsigned i = 0, j = 0, n = 0;
+   while (i < a._size || j < b._size) {
+      if (n == _k) return false;
+      if (j == b._size || (i < a._size && a._leaf[i] < b._leaf[j]))
+         c._leaf[n++] = a._leaf[i++];
+      else if (i == a._size || b._leaf[j] < a._leaf[i])
+         c._leaf[n++] = b._leaf[j++];
+      else { c._leaf[n++] = a._leaf[i++]; ++j; }
+   }
+   c._size = n;
+   return true;
+}
+
+// Add "c" unless it is dominated; remove the cuts dominated by "c"
+bool
+CirCutMgr::addCut(vector<CirCut>& cuts, const CirCut& c) const
+{
+   for (size_t i = 0, n = cuts.size(); i < n; ++i)
+      if (cuts[i].dominates(c)) return false;
+   size_t des = 0;
+   for (size_t i = 0, n = cuts.size(); i < n; ++i) {
+      if (c.dominates(cuts[i])) continue;
+      if (i != des) cuts[des] = cuts[i];
+      ++des;
+   }
+   cuts.resize(des);
+   cuts.push_back(c);
+   return true;
+}
@@ -0,0 +1,117 @@
+/****************************************************************************
+  FileName     [ cirCut.h ]
+  PackageName  [ cir ]
+  Synopsis     [ Define k-feasible cut enumeration over the AIG ]
+  Author       [ Chung-Yang (Ric) Huang ]
+  Copyright    [ Copyleft(c) 2008-present LaDs(III), GIEE, NTU, Taiwan ]
+****************************************************************************/
+
+#ifndef CIR_CUT_H
+#define CIR_CUT_H
+
+#include <vector>
+#include <stdint.h>
+#include "cirDef.h"
+
+using namespace std;
+
+#define CUT_MAX_LEAF  6
+
+//------------------------------------------------------------------------
+//   Truth table helpers (6-input functions in a uint64_t)
+//------------------------------------------------------------------------
+// _truthVar[i] is the elementary function of variable i
+extern const uint64_t _truthVar[CUT_MAX_LEAF];
+
+// swap variable v and v+1 of the truth table
+extern uint64_t truthSwapAdjacent(uint64_t t, unsigned v);
+// re-express t over leaves "from" as a function over leaves "to" (from <= to)
+extern uint64_t truthStretch(uint64_t t, const unsigned* from, unsigned nFrom,
+                             const unsigned* to, unsigned nTo);
+
+//------------------------------------------------------------------------
+//   class CirCut
+//------------------------------------------------------------------------
+// A cut of a root gate: the sorted leaf gate ids and the function of the
+// root in terms of the leaves (leaf i is variable i of _truth).
+class CirCut
+{
+public:
+   CirCut(): _size(0), _sign(0), _truth(0), _delay(0), _area(0) {}
+
+   unsigned size() const { return _size; }
+   unsigned operator [] (unsigned i) const { return _leaf[i]; }
+   uint64_t getTruth() const { return _truth; }
+   bool isTrivial() const { return _size == 1 && _truth == _truthVar[0]; }
+
+   // true if the leaves of this cut are a subset of those of c
+   bool dominates(const CirCut& c) const;
+
+   unsigned   _leaf[CUT_MAX_LEAF];
+   unsigned   _size;
+   uint64_t   _sign;    // bloom signature of the leaves
+   uint64_t   _truth;
+   // cost fields, filled in by the users of the enumerator (e.g. mapper)
+   unsigned   _delay;
+   float      _area;
+};
+
+//------------------------------------------------------------------------
+//   class CirCutMgr
+//------------------------------------------------------------------------
+// Priority cut enumeration: every gate keeps at most _nCuts non-trivial
+// cuts of at most _k leaves plus its trivial cut.  Cuts of all gates in
+// one level live in one arena block, so that a level can be reclaimed as
+// soon as all of its fanouts have been processed (see keepAll).
+class CirCutMgr
+{
+public:
+   CirCutMgr(unsigned k = 4, unsigned nCuts = 8, bool keepAll = true);
+   virtual ~CirCutMgr() { reset(); }
+
+   void enumerate(const CirMgr*);
+   void reset();
+
+   // Access functions; getCuts() returns 0 if the level has been reclaimed
+   unsigned getK() const { return _k; }
+   const CirCut* getCuts(unsigned gid) const {
+      return (gid < _slot.size()) ? _slot[gid] : 0;
+   }
+   unsigned getNumCuts(unsigned gid) const {
+      return (gid < _num.size()) ? _num[gid] : 0;
+   }
+   unsigned getLevel(unsigned gid) const { return _level[gid]; }
+   unsigned getMaxLevel() const { return _levelArena.size() - 1; }
+   const GateList& getOrder() const { return _order; }
+   size_t getTotalCuts() const;
+   size_t getMemUsage() const;
+
+   void releaseLevel(unsigned lvl);
+
+protected:
+   // fill in the cost fields of a newly found cut of gate "gid"
+   virtual void evalCut(unsigned gid, CirCut&) {}
+   // priority order of the cuts kept at a gate (best first)
+   virtual bool cutLess(const CirCut& a, const CirCut& b) const;
+   // called once all cuts of a gate are available
+   virtual void nodeDone(unsigned gid) {}
+
+   const CirMgr*            _mgr;
+   unsigned                 _k;
+   unsigned                 _nCuts;
+   bool                     _keepAll;
+   GateList                 _order;     // gates in level order
+   vector<unsigned>         _level;     // indexed by gate id
+   vector<CirCut*>          _slot;      // indexed by gate id
+   vector<unsigned>         _num;       // indexed by gate id
+   vector<CirCut*>          _levelArena;
+   vector<unsigned>         _levelBegin;   // index into _order
+   vector<unsigned>         _levelLastUse; // highest level of a fanout
+
+private:
+   void computeCuts(CirGate*, CirCut*, vector<CirCut>&);
+   bool mergeCut(const CirCut&, const CirCut&, CirCut&) const;
+   bool addCut(vector<CirCut>&, const CirCut&) const;
+};
+
+#endif // CIR_CUT_H
@@ -0,0 +1,134 @@
+/****************************************************************************
+  FileName     [ cirExtract.cpp ]
+  PackageName  [ cir ]
+  Synopsis     [ Define extraction of the cones of selected POs ]
+  Author       [ Chung-Yang (Ric) Huang ]
+  Copyright    [ Copyleft(c) 2008-present LaDs(III), GIEE, NTU, Taiwan ]
+****************************************************************************/
+
+#include <cassert>
+#include <algorithm>
+#include <unordered_map>
+#include "cirMgr.h"
+#include "cirGate.h"
+#include "util.h"
+
+using namespace std;
+
+/**************************************/
+/*   Static varaibles and functions   */
+/**************************************/
+// PIs in the order of their definitions
+static bool
+piLess(const CirGate* a, const CirGate* b)
+{
+  return a->_lineNo < b->_lineNo || (a->_lineNo == b->_lineNo && a->_id < b->_id);
+}
+
+/****************************************************************/
+/*   class CirMgr member functions for cone extraction          */
+/****************************************************************/
+// Build in the empty circuit "cone" the fanin cones of the POs poIds, as
+// if read from an .aag file of them alone: the PIs are numbered from 1 in
+// their original order, then the AIGs in DFS order, then the undefined
+// gates; the POs keep their order in poIds.  Names of PIs and POs are
+// kept.  Only the gates of the cones are visited.  Return false if some id
+// is not a PO.
+bool
+CirMgr::extractCone(const IdList& poIds, CirMgr& cone) const
+{
+  assert(cone._map.empty());
+  GateList po;
+  for (size_t i = 0; i < poIds.size(); i++) {
+    CirGate* g = getGate(poIds[i]);
+    if (!g || g->_type != PO_GATE) return false;
+    po.push_back(g);
+  }
+
+  // gate of this circuit -> its copy; an entry marks the gate as visited
+  unordered_map<const CirGate*, CirGate*> copy;
+  GateList pi, aig, undef;
+  CirGate* const0 = new CirConstGate();
+  copy[getGate(0)] = const0;
+
+  // post-order DFS with an explicit stack, so deep cones do not overflow
+  vector<pair<const CirGate*, size_t> > stack;
+  for (size_t i = 0; i < po.size(); i++) {
+    const CirGate* root = po[i]->_fanin[0];
+    if (!copy.insert(make_pair(root, (CirGate*)0)).second) continue;
+    stack.push_back(make_pair(root, 0));
+    while (!stack.empty()) {
+      const CirGate* g = stack.back().first;
+      const size_t j = stack.back().second++;
+      if (j < g->_fanin.size()) {
+        const CirGate* f = g->_fanin[j];
+        if (copy.insert(make_pair(f, (CirGate*)0)).second)
+          stack.push_back(make_pair(f, 0));
+        continue;
+      }
+      stack.pop_back();
+      switch (g->_type) {
+        case PI_GATE:    pi.push_back(const_cast<CirGate*>(g)); break;
+        case AIG_GATE:   aig.push_back(const_cast<CirGate*>(g)); break;
+        case UNDEF_GATE: undef.push_back(const_cast<CirGate*>(g)); break;
+        default: break;
+      }
+    }
+  }
+  sort(pi.begin(), pi.end(), piLess);
+
+  // renumber densely; line numbers are those of the written .aag
+  const unsigned nPi = pi.size(), nPo = po.size(), nAig = aig.size();
+  const unsigned maxId = nPi + nAig + undef.size();
+  cone._map.insert(cone._map.end(), make_pair(0u, const0));
+  cone._pi.resize(nPi);
+  for (unsigned i = 0; i < nPi; i++) {
+    CirGate* g = new CirPiGate(i + 1, i + 2);
+    g->_name = pi[i]->_name;
+    copy[pi[i]] = cone._pi[i] = g;
+    cone._map.insert(cone._map.end(), make_pair(g->_id, g));
+  }
+  cone._aig.resize(nAig);
+  for (unsigned i = 0; i < nAig; i++) {
+    CirGate* g = new CirAigGate(nPi + 1 + i, nPi + nPo + 2 + i);
+    copy[aig[i]] = cone._aig[i] = g;
+    cone._map.insert(cone._map.end(), make_pair(g->_id, g));
+  }
+  for (unsigned i = 0; i < undef.size(); i++) {
+    CirGate* g = new CirUndefGate(nPi + nAig + 1 + i);
+    copy[undef[i]] = g;
+    cone._map.insert(cone._map.end(), make_pair(g->_id, g));
+  }
+  cone._po.resize(nPo);
+  for (unsigned i = 0; i < nPo; i++) {
+    CirGate* g = new CirPoGate(maxId + 1 + i, nPi + 2 + i);
+    g->_name = po[i]->_name;
+    cone._po[i] = g;
+    cone._map.insert(cone._map.end(), make_pair(g->_id, g));
+  }
+
+  // connect; the fanouts are in the order of AIGs and then POs, as read
+  for (unsigned i = 0; i < nAig; i++)
+    for (size_t j = 0; j < aig[i]->_fanin.size(); j++) {
+      CirGate* f = copy[aig[i]->_fanin[j]];
+      cone._aig[i]->setFanin(f);
+      cone._aig[i]->setBool(aig[i]->_invert[j]);
+      f->setFanout(cone._aig[i]);
+    }
+  for (unsigned i = 0; i < nPo; i++) {
+    CirGate* f = copy[po[i]->_fanin[0]];
+    cone._po[i]->setFanin(f);
+    cone._po[i]->setBool(po[i]->_invert[0]);
+    f->setFanout(cone._po[i]);
+  }
+
+  cone._header.clear();
+  cone._header.push_back("aag");
+  cone._header.push_back(to_string(maxId));
+  cone._header.push_back(to_string(nPi));
+  cone._header.push_back("0");
+  cone._header.push_back(to_string(nPo));
+  cone._header.push_back(to_string(nAig));
+  cone._fileName = _fileName;
+  return true;
+}
@@ -0,0 +1,349 @@
+/****************************************************************************
+  FileName     [ cirFault.cpp ]
+  PackageName  [ cir ]
+  Synopsis     [ Define stuck-at fault simulation ]
+  Author       [ Chung-Yang (Ric) Huang ]
+  Copyright    [ Copyleft(c) 2008-present LaDs(III), GIEE, NTU, Taiwan ]
+****************************************************************************/
+
+#include <iostream>
+#include <iomanip>
+#include <algorithm>
+#include <climits>
+#include <queue>
+#include <thread>
+#include <stdint.h>
+#include "cirMgr.h"
+#include "cirGate.h"
+#include "util.h"
+
+using namespace std;
+
+/**************************************/
+/*   Static varaibles and functions   */
+/**************************************/
+// A fault is simulated on blocks of FAULT_WORDS x 64 patterns
+#define FAULT_WORDS   4
+
+static const unsigned noPos = UINT_MAX;
+
+// The output of _gate, or the literal at its fanin _pin (after the
+// inverter of the edge), stuck at _value
+struct CirFault
+{
+   CirFault(unsigned g, int pin, bool v): _gate(g), _pin(pin), _value(v) {}
+
+   unsigned   _gate;     // position in the DFS list
+   int        _pin;      // -1 for the output
+   bool       _value;
+};
+
+// The gates in DFS order, by their positions: the fanins as literals
+// (position x 2 + inverted) and the fanouts in compressed sparse rows
+struct CirFaultNet
+{
+   vector<const CirGate*>   _gate;
+   vector<unsigned>         _fanin;     // 2 per gate, noPos if none
+   vector<unsigned>         _foOffset;
+   vector<unsigned>         _fanout;
+   vector<uint64_t>         _good;      // nWords per gate
+   size_t                   _nWords;
+};
+
+static inline uint64_t
+randomWord(RandomNumGen& gen)
+{
+   uint64_t w = 0;
+   for (unsigned b = 0; b < 64; b += 16)
+      w |= uint64_t(gen(1 << 16)) << b;
+   return w;
+}
+
+static unsigned
+findClass(vector<unsigned>& parent, unsigned i)
+{
+   while (parent[i] != i) i = parent[i] = parent[parent[i]];
+   return i;
+}
+
+// The smaller index becomes the root, so an output fault, if any,
+// represents its class
+static void
+mergeClass(vector<unsigned>& parent, unsigned i, unsigned j)
+{
+   i = findClass(parent, i);
+   j = findClass(parent, j);
+   if (i < j) parent[j] = i;
+   else parent[i] = j;
+}
+
+// Propagation of one fault at a time; each thread has its own
+class CirFaultSim
+{
+public:
+   CirFaultSim(const CirFaultNet& net): _net(net), _serial(0),
+      _val(net._gate.size() * FAULT_WORDS), _stamp(net._gate.size(), 0),
+      _queued(net._gate.size(), 0) {}
+
+   // The first block of patterns that detects f, or nBlocks
+   size_t detect(const CirFault& f) {
+      const size_t nBlocks = _net._nWords / FAULT_WORDS;
+      for (size_t b = 0; b < nBlocks; b++)
+         if (detect(f, b)) return b;
+      return nBlocks;
+   }
+
+private:
+   typedef priority_queue<unsigned, vector<unsigned>, greater<unsigned> >
+      PosQueue;
+
+   const CirFaultNet&   _net;
+   unsigned             _serial;
+   vector<uint64_t>     _val;       // faulty values, valid if stamped
+   vector<unsigned>     _stamp;
+   vector<unsigned>     _queued;
+   PosQueue             _events;
+
+   const uint64_t* value(unsigned p, size_t b) const {
+      if (_stamp[p] == _serial) return &_val[p * FAULT_WORDS];
+      return &_net._good[p * _net._nWords + b * FAULT_WORDS];
+   }
+   void push(unsigned p) {
+      if (_queued[p] == _serial) return;
+      _queued[p] = _serial;
+      _events.push(p);
+   }
+   void pushFanouts(unsigned p) {
+      for (unsigned i = _net._foOffset[p]; i < _net._foOffset[p + 1]; i++)
+         push(_net._fanout[i]);
+   }
+   // Store v as the faulty value of p if it differs from the good one
+   bool setValue(unsigned p, size_t b, const uint64_t* v) {
+      const uint64_t* g = &_net._good[p * _net._nWords + b * FAULT_WORDS];
+      uint64_t diff = 0;
+      for (unsigned w = 0; w < FAULT_WORDS; w++) diff |= v[w] ^ g[w];
+      if (!diff) return false;
+      copy(v, v + FAULT_WORDS, &_val[p * FAULT_WORDS]);
+      _stamp[p] = _serial;
+      return true;
+   }
+
+   // Events in the fanout cone of the fault, fanins first; a gate whose
+   // faulty value equals the good one stops there
+   bool detect(const CirFault& f, size_t b) {
+      ++_serial;
+      _events = PosQueue();
+      const uint64_t stuck = f._value ? ~uint64_t(0) : 0;
+      uint64_t v[FAULT_WORDS];
+      if (f._pin < 0) {
+         fill(v, v + FAULT_WORDS, stuck);
+         if (!setValue(f._gate, b, v)) return false;
+         pushFanouts(f._gate);
+      }
+      else push(f._gate);
+
+      while (!_events.empty()) {
+         const unsigned p = _events.top();
+         _events.pop();
+         const CirGate* g = _net._gate[p];
+         uint64_t lit[2][FAULT_WORDS];
+         const size_t nFanin = g->_type == AIG_GATE ? 2 : 1;
+         for (size_t k = 0; k < nFanin; k++) {
+            if (p == f._gate && int(k) == f._pin) {
+               fill(lit[k], lit[k] + FAULT_WORDS, stuck);
+               continue;
+            }
+            const unsigned l = _net._fanin[2 * p + k];
+            const uint64_t* a = value(l >> 1, b);
+            const uint64_t inv = (l & 1) ? ~uint64_t(0) : 0;
+            for (unsigned w = 0; w < FAULT_WORDS; w++) lit[k][w] = a[w] ^ inv;
+         }
+         if (nFanin == 2)
+            for (unsigned w = 0; w < FAULT_WORDS; w++)
+               v[w] = lit[0][w] & lit[1][w];
+         else copy(lit[0], lit[0] + FAULT_WORDS, v);
+         if (!setValue(p, b, v)) continue;
+         if (g->_type == PO_GATE) return true;
+         pushFanouts(p);
+      }
+      return false;
+   }
+};
+
+/**************************************************************/
+/*   class CirMgr member functions for fault simulation       */
+/**************************************************************/
+// Stuck-at faults of the gates in the DFS list: at the outputs of the
+// PIs and AIGs and at the fanin literals of the AIGs and POs.  They are
+// collapsed into equivalence classes:
+//    - a fanin literal of an AIG stuck at 0 is its output stuck at 0,
+//    - the fanin literal of a PO is the PO,
+//    - a gate of one fanout is the literal it drives (with the inverter).
+// Only the first fault of each class is simulated.  The good values of
+// nPatterns random patterns (rounded up to FAULT_WORDS x 64) are simulated
+// first; then nThreads threads take the classes one by one and propagate
+// each fault a block at a time until a PO differs.  A detected fault is
+// not simulated on the blocks after.
+void
+CirMgr::faultSim(size_t nPatterns, unsigned seed, unsigned nThreads,
+                 bool listUndetected) const
+{
+  const GateList& dfsTl = getDfsList();
+  const size_t n = dfsTl.size();
+  CirFaultNet net;
+  net._gate.assign(dfsTl.begin(), dfsTl.end());
+  net._nWords = max<size_t>(1, (nPatterns + FAULT_WORDS * 64 - 1) /
+                               (FAULT_WORDS * 64)) * FAULT_WORDS;
+  vector<unsigned> pos(getGateIdEnd(), noPos);
+  for (size_t i = 0; i < n; i++) pos[dfsTl[i]->_id] = i;
+
+  net._fanin.assign(2 * n, noPos);
+  net._foOffset.assign(n + 1, 0);
+  for (size_t i = 0; i < n; i++) {
+    const CirGate* g = dfsTl[i];
+    for (size_t k = 0; k < g->_fanin.size() && k < 2; k++) {
+      net._fanin[2 * i + k] = pos[g->_fanin[k]->_id] * 2 + g->_invert[k];
+      net._foOffset[pos[g->_fanin[k]->_id] + 1]++;
+    }
+  }
+  for (size_t i = 0; i < n; i++) net._foOffset[i + 1] += net._foOffset[i];
+  net._fanout.resize(net._foOffset[n]);
+  vector<unsigned> slot(net._foOffset.begin(), net._foOffset.end() - 1);
+  for (size_t i = 0; i < n; i++)
+    for (size_t k = 0; k < 2 && net._fanin[2 * i + k] != noPos; k++)
+      net._fanout[slot[net._fanin[2 * i + k] >> 1]++] = i;
+
+  // good values
+  const size_t nw = net._nWords;
+  net._good.resize(n * nw);
+  RandomNumGen gen(seed);
+  for (size_t i = 0; i < n; i++) {
+    const CirGate* g = dfsTl[i];
+    uint64_t* v = &net._good[i * nw];
+    if (g->_type == PI_GATE)
+      for (size_t w = 0; w < nw; w++) v[w] = randomWord(gen);
+    else if (g->_type == AIG_GATE || g->_type == PO_GATE) {
+      const unsigned la = net._fanin[2 * i];
+      const uint64_t* a = &net._good[(la >> 1) * nw];
+      const uint64_t ia = (la & 1) ? ~uint64_t(0) : 0;
+      if (g->_type == PO_GATE)
+        for (size_t w = 0; w < nw; w++) v[w] = a[w] ^ ia;
+      else {
+        const unsigned lb = net._fanin[2 * i + 1];
+        const uint64_t* b = &net._good[(lb >> 1) * nw];
+        const uint64_t ib = (lb & 1) ? ~uint64_t(0) : 0;
+        for (size_t w = 0; w < nw; w++) v[w] = (a[w] ^ ia) & (b[w] ^ ib);
+      }
+    }
+    else
+      for (size_t w = 0; w < nw; w++) v[w] = 0;
+  }
+
+  // faults, the outputs first
+  vector<CirFault> faults;
+  vector<unsigned> outFault(n, noPos), pinFault(n, noPos);
+  for (size_t i = 0; i < n; i++) {
+    const GateType t = dfsTl[i]->_type;
+    if (t != PI_GATE && t != AIG_GATE) continue;
+    outFault[i] = faults.size();
+    faults.push_back(CirFault(i, -1, false));
+    faults.push_back(CirFault(i, -1, true));
+  }
+  for (size_t i = 0; i < n; i++) {
+    const GateType t = dfsTl[i]->_type;
+    if (t != AIG_GATE && t != PO_GATE) continue;
+    pinFault[i] = faults.size();
+    for (int k = 0; k < (t == AIG_GATE ? 2 : 1); k++) {
+      faults.push_back(CirFault(i, k, false));
+      faults.push_back(CirFault(i, k, true));
+    }
+  }
+
+  vector<unsigned> parent(faults.size());
+  for (size_t f = 0; f < faults.size(); f++) parent[f] = f;
+  for (size_t i = 0; i < n; i++) {
+    const GateType t = dfsTl[i]->_type;
+    if (t == AIG_GATE) {
+      mergeClass(parent, pinFault[i], outFault[i]);
+      mergeClass(parent, pinFault[i] + 2, outFault[i]);
+    }
+    // a PO has no output fault; its two pin faults stay apart
+    if (outFault[i] == noPos ||
+        net._foOffset[i + 1] - net._foOffset[i] != 1) continue;
+    const unsigned fo = net._fanout[net._foOffset[i]];
+    const unsigned k = (net._fanin[2 * fo] >> 1) == i ? 0 : 1;
+    const unsigned inv = net._fanin[2 * fo + k] & 1;
+    for (unsigned v = 0; v < 2; v++)
+      mergeClass(parent, outFault[i] + v, pinFault[fo] + 2 * k + (v ^ inv));
+  }
+  vector<unsigned> reps, classOf(faults.size());
+  vector<size_t> classSize;
+  for (size_t f = 0; f < faults.size(); f++) {
+    if (findClass(parent, f) == f) {
+      classOf[f] = reps.size();
+      reps.push_back(f);
+      classSize.push_back(0);
+    }
+    classOf[f] = classOf[findClass(parent, f)];
+    classSize[classOf[f]]++;
+  }
+
+  // the classes are taken one at a time by the threads
+  const size_t nBlocks = nw / FAULT_WORDS;
+  vector<size_t> detectedAt(reps.size(), nBlocks);
+  atomic<size_t> next(0);
+  auto worker = [&]() {
+    CirFaultSim sim(net);
+    for (size_t c; (c = next++) < reps.size(); )
+      detectedAt[c] = sim.detect(faults[reps[c]]);
+  };
+  nThreads = max(1u, min<unsigned>(nThreads, reps.size()));
+  vector<thread> workers;
+  for (unsigned t = 1; t < nThreads; t++) workers.push_back(thread(worker));
+  worker();
+  for (size_t t = 0; t < workers.size(); t++) workers[t].join();
+
+  size_t nDetected = 0, nDetectedClasses = 0;
+  vector<size_t> byBlock(nBlocks + 1, 0);
+  for (size_t c = 0; c < reps.size(); c++) {
+    byBlock[detectedAt[c]] += classSize[c];
+    if (detectedAt[c] == nBlocks) continue;
+    nDetected += classSize[c];
+    ++nDetectedClasses;
+  }
+  const double nFaults = faults.empty() ? 1 : faults.size();
+  const double nClasses = reps.empty() ? 1 : reps.size();
+  cout << "Faults          " << faults.size() << " in " << reps.size()
+       << " equivalence class(es)" << endl
+       << "Patterns        " << nw * 64 << " (" << nThreads << " thread(s))"
+       << endl
+       << "Detected        " << nDetected << " fault(s), "
+       << nDetectedClasses << " class(es)" << endl
+       << fixed << setprecision(2)
+       << "Fault coverage  " << 100 * nDetected / nFaults << "% ("
+       << 100 * nDetectedClasses / nClasses << "% collapsed)" << endl;
+  // the coverage after each doubling of the patterns
+  size_t covered = 0;
+  for (size_t b = 0, mark = 1; b < nBlocks; b++) {
+    covered += byBlock[b];
+    if (b + 1 != mark && b + 1 != nBlocks) continue;
+    cout << "  " << setw(10) << right << (b + 1) * FAULT_WORDS * 64
+         << " patterns  " << setw(7) << 100 * covered / nFaults << "%" << endl;
+    mark *= 2;
+  }
+  cout.unsetf(ios::floatfield);
+  cout << setprecision(6);
+
+  if (!listUndetected) return;
+  for (size_t c = 0; c < reps.size(); c++) {
+    if (detectedAt[c] != nBlocks) continue;
+    const CirFault& f = faults[reps[c]];
+    const CirGate* g = dfsTl[f._gate];
+    cout << g->getTypeStr() << " " << g->_id;
+    if (g->_name.size()) cout << " (" << g->_name << ")";
+    if (f._pin >= 0) cout << " fanin " << f._pin;
+    cout << " stuck-at-" << f._value;
+    if (classSize[c] > 1) cout << " (+" << classSize[c] - 1 << " equivalent)";
+    cout << endl;
+  }
+}
@@ -15,6 +15,7 @@
 #include "cirGate.h"
 #include "cirMgr.h"
 #include "util.h"
+#include "myWriter.h"
 
 using namespace std;
 
@@ -28,118 +29,61 @@ extern CirMgr *cirMgr;
 void
 CirGate::reportGate() const
 {
-  cout << "==================================================" << endl;
+  MyWriter out(cout);
+  out << "==================================================" << '\n';
   stringstream ss;
   ss << "= " + getTypeStr() << '(' << _id << ")";
   if (_name != "") {
     ss << "\"" << _name << "\"";
   }
   ss << ", line " << getLineNo();
-  cout << setw(49) << left << ss.str() << "=" << endl;
-  cout << "==================================================" << endl;
+  out.left(ss.str(), 49) << "=" << '\n';
+  out << "==================================================" << '\n';
 }
 
 void
-CirGate::travelGateIn(CirGate* gate, bool inv, int level, GateList& report) const {
-  for (size_t i = 0; i < _currentTravelLevel; i++) { cout << "  "; }
-  if (inv) { cout << "!"; }
-  cout << gate->getTypeStr() << " " << gate->_id;
-
-  GateList::iterator it;
-  it = find(report.begin(), report.end(), gate);
-  if (it != report.end()) {
-    if (gate->_fanin.size() > 0) {
-      cout << " (*)" << endl;
-    } else {
-      cout << endl;
-    }
-  } else {
-    cout << endl;
-    report.push_back(gate);
-    if (_currentTravelLevel < level && gate->_fanin.size() > 0) {
-      _currentTravelLevel++;
-      for (size_t i = 0; i < gate->_fanin.size(); i++) {
-        travelGateIn(gate->_fanin[i], gate->_invert[i], level, report);
-      }
-      _currentTravelLevel--;
+CirGate::dfsTraversal(GateList& dfsTl, CirTravContext& ctx) const
+{
+  for (size_t i = 0; i < _fanin.size(); i++) {
+    if (!ctx.isMarked(_fanin[i])) {
+      ctx.mark(_fanin[i]);
+      _fanin[i]->dfsTraversal(dfsTl, ctx);
     }
   }
-};
+  dfsTl.push_back(const_cast<CirGate*>(this));
+}
+
+// CIRGate -FANIn / -FANOut: one line per cone entry, indented by its depth
+static void
+printCone(const vector<CirConeEntry>& cone)
+{
+  MyWriter out(cout);
+  for (size_t i = 0; i < cone.size(); i++) {
+    const CirConeEntry& e = cone[i];
+    out.fill(' ', 2 * e._depth);
+    if (e._inv) { out << "!"; }
+    out << e._gate->getTypeStr() << " " << e._gate->_id;
+    if (e._elided) { out << " (*)"; }
+    out << '\n';
+  }
+}
 
 void
 CirGate::reportFanin(int level) const
 {
    assert (level >= 0);
-   GateList report;
-
-   cout << getTypeStr() << " " << _id << endl;
-   if (_currentTravelLevel < level  && _fanin.size() > 0) {
-     _currentTravelLevel++;
-     for (size_t i = 0; i < _fanin.size(); i++) {
-       travelGateIn(_fanin[i], _invert[i], level, report);
-     }
-     _currentTravelLevel--;
-   }
+   vector<CirConeEntry> cone;
+   CirTravContext ctx(cirMgr->getGateIdEnd());
+   cirMgr->queryFanin(_id, level, cone, ctx);
+   printCone(cone);
 }
 
-void
-CirGate::travelGateOut(CirGate* gate, bool inv, int level, GateList& report) const {
-  for (size_t i = 0; i < _currentTravelLevel; i++) { cout << "  "; }
-  if (inv) { cout << "!"; }
-  cout << gate->getTypeStr() << " " << gate->_id;
-
-  GateList::iterator it;
-  it = find(report.begin(), report.end(), gate);
-  if (it != report.end()) {
-    if (gate->_fanout.size() > 0) {
-      cout << " (*)" << endl;
-    } else {
-      cout << endl;
-    }
-  } else {
-    cout << endl;
-    report.push_back(gate);
-    if (_currentTravelLevel < level && gate->_fanout.size() > 0) {
-      _currentTravelLevel++;
-      for (size_t i = 0; i < gate->_fanout.size(); i++) {
-
-        bool invert = true;
-        for (size_t j = 0; j < gate->_fanout[i]->_fanin.size(); j++) {
-          if (gate->_fanout[i]->_fanin[j] == gate) {
-            invert = gate->_fanout[i]->_invert[j];
-          }
-        }
-        travelGateOut(gate->_fanout[i], invert, level, report);
-      }
-      _currentTravelLevel--;
-    }
-  }
-};
-
 void
 CirGate::reportFanout(int level) const
 {
    assert (level >= 0);
-   GateList report;
-
-   cout << getTypeStr() << " " << _id << endl;
-   if (_currentTravelLevel < level  && _fanout.size() > 0) {
-     _currentTravelLevel++;
-     for (size_t i = 0; i < _fanout.size(); i++) {
-       bool invert = true;
-       for (size_t j = 0; j < _fanout[i]->_fanin.size(); j++) {
-         if (_fanout[i]->_fanin[j] == this) {
-           invert = _fanout[i]->_invert[j];
-         }
-       }
-       travelGateOut(_fanout[i], invert, level, report);
-     }
-     _currentTravelLevel--;
-   }
+   vector<CirConeEntry> cone;
+   CirTravContext ctx(cirMgr->getGateIdEnd());
+   cirMgr->queryFanout(_id, level, cone, ctx);
+   printCone(cone);
 }
-
-unsigned
-CirGate::_globalRef = 0;
-
-int
-CirGate::_currentTravelLevel = 0;
@@ -18,16 +18,37 @@
 using namespace std;
 
 class CirGate;
+class CirTravContext;
 
 //------------------------------------------------------------------------
 //   Define classes
 //------------------------------------------------------------------------
+// A gate pointer with the inverted flag packed in its LSB (an AIG literal)
+class CirGateV
+{
+public:
+   static const size_t NEG = 0x1;
+
+   CirGateV(CirGate* g = 0, bool inv = false): _gateV(size_t(g) | size_t(inv)) {}
+
+   CirGate* gate() const { return (CirGate*)(_gateV & ~size_t(NEG)); }
+   bool isInv() const { return (_gateV & NEG); }
+   CirGateV operator ! () const { return CirGateV(gate(), !isInv()); }
+   CirGateV operator ^ (bool inv) const { return CirGateV(gate(), isInv() ^ inv); }
+   bool operator == (const CirGateV& v) const { return _gateV == v._gateV; }
+   bool operator != (const CirGateV& v) const { return _gateV != v._gateV; }
+
+private:
+   size_t _gateV;
+};
+
 // TODO: Define your own data members and member functions, or classes
 class CirGate
 {
 public:
    CirGate(GateType type, unsigned id, unsigned lineNo):
-   _type(type), _id(id), _lineNo(lineNo), _fanin(0), _fanout(0), _name(""), _ref(initRef()) {}
+   _type(type), _id(id), _lineNo(lineNo), _fanin(0), _fanout(0), _name(""),
+   _cowStamp(0) {}
    virtual ~CirGate() {}
 
    GateType _type;
@@ -38,9 +59,8 @@ public:
    vector<bool> _invert;
    string _name;
 
-   static unsigned _globalRef;
-   unsigned _ref;
-   static int _currentTravelLevel;
+   // serial of the snapshot that has saved this gate (see CirMgr::touch)
+   unsigned _cowStamp;
 
    // Basic access methods
    string getTypeStr() const {
@@ -66,6 +86,20 @@ public:
      _fanout.push_back(fanOut);
    };
 
+   // remove one occurrence of fanOut
+   void removeFanout(CirGate* fanOut) {
+     for (size_t i = 0; i < _fanout.size(); i++) {
+       if (_fanout[i] == fanOut) {
+         _fanout.erase(_fanout.begin() + i);
+         return;
+       }
+     }
+   }
+
+   CirGateV getFanin(size_t i) const {
+     return CirGateV(_fanin[i], _invert[i]);
+   }
+
    void setBool(bool invert) {
      _invert.push_back(invert);
    }
@@ -91,36 +125,8 @@ public:
    }
 
    // DFS Travseral
-   bool isGlobalRef() {
-     return (_ref == _globalRef);
-   }
-
-   void setToGlobalRef() {
-     _ref = _globalRef;
-   }
-
-   static void setGlobalRef() {
-     _globalRef++;
-   }
-
-   static unsigned initRef() {
-     return _globalRef;
-   }
+   void dfsTraversal(GateList& dfsTl, CirTravContext& ctx) const;
 
-   void dfsTraversal(GateList& dfsTl) {
-     if (_fanin.size() > 0) {
-       for (size_t i = 0; i < _fanin.size(); i++) {
-         if(!_fanin[i]->isGlobalRef()) {
-           _fanin[i]->setToGlobalRef();
-           _fanin[i]->dfsTraversal(dfsTl);
-         }
-       }
-     }
-     dfsTl.push_back(this);
-   }
-
-   void travelGateIn(CirGate* gate, bool inv, int level, GateList& report) const;
-   void travelGateOut(CirGate* gate, bool inv, int level, GateList& report) const;
    void reportGate() const;
    void reportFanin(int level) const;
    void reportFanout(int level) const;
@@ -155,5 +161,34 @@ public:
   CirConstGate(): CirGate(CONST_GATE, 0, 0) {}
 };
 
+// Visited marks of traversals over one circuit, indexed by gate id.
+// newTrav() clears all the marks by moving to a new epoch.  Every
+// traversal owns its context, so traversals on different threads can share
+// a read-only netlist.  Only the marks are kept here; the depth of a
+// fanin / fanout report is an argument of each recursive call.
+class CirTravContext
+{
+public:
+   CirTravContext(unsigned nIds = 0): _epoch(1), _mark(nIds, 0) {}
+
+   void newTrav() {
+     if (++_epoch == 0) {
+       _mark.assign(_mark.size(), 0);
+       _epoch = 1;
+     }
+   }
+   bool isMarked(const CirGate* g) const {
+     return g->_id < _mark.size() && _mark[g->_id] == _epoch;
+   }
+   void mark(const CirGate* g) {
+     if (g->_id >= _mark.size()) _mark.resize(g->_id + 1, 0);
+     _mark[g->_id] = _epoch;
+   }
+
+private:
+   unsigned           _epoch;
+   vector<unsigned>   _mark;
+};
+
 
 #endif // CIR_GATE_H
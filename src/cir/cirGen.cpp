@@ -0,0 +1,137 @@
+/****************************************************************************
+  FileName     [ cirGen.cpp ]
+  PackageName  [ cir ]
+  Synopsis     [ Define the synthetic AIG generator ]
+  Author       [ Chung-Yang (Ric) Huang ]
+  Copyright    [ Copyleft(c) 2008-present LaDs(III), GIEE, NTU, Taiwan ]
+****************************************************************************/
+
+#include <cmath>
+#include <climits>
+#include <sstream>
+#include "cirGen.h"
+#include "myWriter.h"
+
+using namespace std;
+
+/**************************************/
+/*   Static varaibles and functions   */
+/**************************************/
+// AIGs of the current level remembered for the redundant copies
+#define CIR_GEN_RECENT   1024
+
+static const char* profileStr[CIR_GEN_TOT] = { "flat", "taper", "grow" };
+
+/*******************************************/
+/*   class CirGenerator member functions   */
+/*******************************************/
+string
+CirGenerator::check() const
+{
+   const CirGenParam& p = _param;
+   if (p._nPi == 0) return "at least one PI is needed";
+   if (p._depth == 0) return "the depth must be positive";
+   if (p._nAnd && p._nAnd < p._depth)
+      return "fewer AIGs than levels";
+   if (double(p._nPi) + p._nAnd + p._nPo >= INT_MAX)
+      return "too many gates";
+   if (!(p._fanoutSkew > 0)) return "the fanout skew must be positive";
+   if (!(p._redundancy >= 0 && p._redundancy <= 1))
+      return "the redundancy rate must be in [0, 1]";
+   return "";
+}
+
+// Level l >= 1 gets max(1, ...) AIGs in proportion to its weight
+void
+CirGenerator::initLevels()
+{
+   const unsigned nLevels = _param._nAnd ? _param._depth : 0;
+   vector<double> weight(nLevels + 1, 0);
+   for (unsigned l = 1; l <= nLevels; l++) {
+      double w = 1;
+      if (_param._profile == CIR_GEN_TAPER) w = nLevels - l + 1;
+      else if (_param._profile == CIR_GEN_GROW) w = l;
+      weight[l] = weight[l - 1] + w;
+   }
+   // level 0 is the PIs
+   _levelStart.assign(nLevels + 2, 1);
+   const double spare = _param._nAnd - nLevels;
+   for (unsigned l = 1; l <= nLevels; l++)
+      _levelStart[l] = 1 + _param._nPi + (l - 1) +
+         unsigned(spare * weight[l - 1] / weight[nLevels]);
+   _levelStart[nLevels + 1] = 1 + _param._nPi + _param._nAnd;
+}
+
+unsigned
+CirGenerator::pickSkewed(unsigned n)
+{
+   if (_param._fanoutSkew == 1) return pick(n);
+   const double u = _gen(1 << 30) / double(1 << 30);
+   const unsigned r = unsigned(n * pow(u, _param._fanoutSkew));
+   return r < n ? r : n - 1;
+}
+
+void
+CirGenerator::generate(ostream& os)
+{
+   initLevels();
+   const unsigned nPi = _param._nPi, nPo = _param._nPo;
+   const unsigned nAnd = _param._nAnd;
+   const unsigned nLevels = _levelStart.size() - 2;
+   MyWriter out(os, 1 << 20);
+   out << "aag " << nPi + nAnd << ' ' << nPi << " 0 " << nPo << ' ' << nAnd
+       << '\n';
+   for (unsigned i = 1; i <= nPi; i++)
+      out << 2 * i << '\n';
+
+   // the POs are spread over the last level, then drawn from all the AIGs
+   const unsigned last = _levelStart[nLevels];
+   const unsigned width = _levelStart[nLevels + 1] - last;
+   for (unsigned j = 0; j < nPo; j++) {
+      unsigned v;
+      if (!nAnd) v = 1 + pick(nPi);
+      else if (nPo <= width) v = last + size_t(j) * width / nPo;
+      else if (j < width) v = last + j;
+      else v = 1 + nPi + pick(nAnd);
+      out << 2 * v + coin() << '\n';
+   }
+
+   vector<unsigned> recent;
+   recent.reserve(2 * CIR_GEN_RECENT);
+   unsigned nRecent = 0;
+   for (unsigned l = 1; l <= nLevels; l++) {
+      const unsigned prev = _levelStart[l - 1], cur = _levelStart[l];
+      nRecent = 0;
+      recent.clear();
+      for (unsigned v = cur; v < _levelStart[l + 1]; v++) {
+         unsigned a, b;
+         if (nRecent && chance(_param._redundancy)) {
+            const unsigned k = pick(min(nRecent, unsigned(CIR_GEN_RECENT)));
+            a = recent[2 * k];
+            b = recent[2 * k + 1];
+            if (coin()) swap(a, b);
+            ++_nRedundant;
+         }
+         else {
+            // one fanin on the previous level, the other on any earlier one
+            a = 2 * (prev + pick(cur - prev)) + coin();
+            b = 2 * (1 + pickSkewed(cur - 1)) + coin();
+            if (b / 2 == a / 2 && cur > 2)
+               b = 2 * (1 + (b / 2 + pick(cur - 2)) % (cur - 1)) + (b & 1);
+            if (coin()) swap(a, b);
+            const unsigned k = nRecent++ % CIR_GEN_RECENT;
+            if (2 * k == recent.size()) { recent.push_back(a); recent.push_back(b); }
+            else { recent[2 * k] = a; recent[2 * k + 1] = b; }
+         }
+         out << 2 * v << ' ' << a << ' ' << b << '\n';
+      }
+   }
+
+   // the comment records how to generate the file again
+   ostringstream cmd;
+   cmd << "CIRGENerate -PI " << nPi << " -PO " << nPo << " -AND " << nAnd
+       << " -Depth " << _param._depth << " -PRofile "
+       << profileStr[_param._profile] << " -Fanout " << _param._fanoutSkew
+       << " -Redundancy " << _param._redundancy << " -Seed " << _param._seed;
+   out << "c\n" << cmd.str() << '\n';
+}
@@ -0,0 +1,82 @@
+/****************************************************************************
+  FileName     [ cirGen.h ]
+  PackageName  [ cir ]
+  Synopsis     [ Define the synthetic AIG generator ]
+  Author       [ Chung-Yang (Ric) Huang ]
+  Copyright    [ Copyleft(c) 2008-present LaDs(III), GIEE, NTU, Taiwan ]
+****************************************************************************/
+
+#ifndef CIR_GEN_H
+#define CIR_GEN_H
+
+#include <iostream>
+#include <vector>
+#include <string>
+#include "rnGen.h"
+
+using namespace std;
+
+enum CirGenProfile
+{
+   CIR_GEN_FLAT  = 0,   // the same number of AIGs on every level
+   CIR_GEN_TAPER = 1,   // wide at the PIs, narrow at the POs
+   CIR_GEN_GROW  = 2,   // narrow at the PIs, wide at the POs
+
+   CIR_GEN_TOT
+};
+
+struct CirGenParam
+{
+   CirGenParam(): _nPi(64), _nPo(32), _nAnd(10000), _depth(100),
+      _profile(CIR_GEN_FLAT), _fanoutSkew(1.0), _redundancy(0.0), _seed(1) {}
+
+   unsigned        _nPi;
+   unsigned        _nPo;
+   unsigned        _nAnd;
+   unsigned        _depth;
+   CirGenProfile   _profile;
+   // the second fanin of an AIG is earlier gate n * u^_fanoutSkew, u in
+   // [0, 1): 1 is uniform, > 1 gives the early gates heavy fanouts and
+   // < 1 favors the recent ones
+   double          _fanoutSkew;
+   // fraction of AIGs that repeat an AIG of the same level
+   double          _redundancy;
+   unsigned        _seed;
+};
+
+//------------------------------------------------------------------------
+//   class CirGenerator
+//------------------------------------------------------------------------
+// Writes a random AIG as an .aag file on the fly; the memory used does
+// not depend on the number of AIGs.  The PIs are variables 1..I and the
+// AIGs I+1..I+A, level by level; every AIG on level l has a fanin on level
+// l - 1, and the POs are spread over the last level first, so the depth is
+// exactly _depth.  The same parameters always give the same file.
+class CirGenerator
+{
+public:
+   CirGenerator(const CirGenParam& p): _param(p), _gen(p._seed),
+      _nRedundant(0) {}
+
+   // error message if the parameters cannot be generated, or ""
+   string check() const;
+   void generate(ostream& os);
+   size_t getNumRedundant() const { return _nRedundant; }
+
+private:
+   CirGenParam        _param;
+   RandomNumGen       _gen;
+   vector<unsigned>   _levelStart;   // first variable of each level
+   size_t             _nRedundant;
+
+   unsigned pick(unsigned n) {
+      const unsigned r = _gen(n);
+      return r < n ? r : n - 1;
+   }
+   bool coin() { return _gen(2) > 0; }
+   bool chance(double p) { return _gen(1 << 30) < p * (1 << 30); }
+   unsigned pickSkewed(unsigned n);
+   void initLevels();
+};
+
+#endif // CIR_GEN_H
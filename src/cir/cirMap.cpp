@@ -0,0 +1,380 @@
+/****************************************************************************
+  FileName     [ cirMap.cpp ]
+  PackageName  [ cir ]
+  Synopsis     [ Define k-LUT technology mapping ]
+  Author       [ Chung-Yang (Ric) Huang ]
+  Copyright    [ Copyleft(c) 2008-present LaDs(III), GIEE, NTU, Taiwan ]
+****************************************************************************/
+
+#include <iostream>
+#include <sstream>
+#include <cassert>
+#include <climits>
+#include <set>
+#include "cirMgr.h"
+#include "cirGate.h"
+#include "cirCut.h"
+#include "util.h"
+
+using namespace std;
+
+/**************************************/
+/*   Static varaibles and functions   */
+/**************************************/
+// Cofactors of a 6-input truth table with respect to variable v
+static inline uint64_t
+truthCof0(uint64_t t, unsigned v)
+{
+   t &= ~_truthVar[v];
+   return t | (t << (1u << v));
+}
+
+static inline uint64_t
+truthCof1(uint64_t t, unsigned v)
+{
+   t &= _truthVar[v];
+   return t | (t >> (1u << v));
+}
+
+// Minato-Morreale irredundant SOP of any f with lower <= f <= upper.
+// Return the function of the cover and append its cubes ('0', '1', '-').
+static uint64_t
+truthIsop(uint64_t lower, uint64_t upper, unsigned nVars, unsigned nAll,
+          vector<string>& cubes)
+{
+   if (lower == 0) return 0;
+   if (upper == ~0ULL) {
+      cubes.push_back(string(nAll, '-'));
+      return ~0ULL;
+   }
+   int v = int(nVars) - 1;
+   for (; v >= 0; --v)
+      if (truthCof0(lower, v) != truthCof1(lower, v) ||
+          truthCof0(upper, v) != truthCof1(upper, v)) break;
+   assert(v >= 0);
+   const uint64_t l0 = truthCof0(lower, v), l1 = truthCof1(lower, v);
+   const uint64_t u0 = truthCof0(upper, v), u1 = truthCof1(upper, v);
+
+   size_t b0 = cubes.size();
+   const uint64_t r0 = truthIsop(l0 & ~u1, u0, v, nAll, cubes);
+   for (size_t i = b0; i < cubes.size(); ++i) cubes[i][v] = '0';
+   size_t b1 = cubes.size();
+   const uint64_t r1 = truthIsop(l1 & ~u0, u1, v, nAll, cubes);
+   for (size_t i = b1; i < cubes.size(); ++i) cubes[i][v] = '1';
+   const uint64_t r2 = truthIsop((l0 & ~r0) | (l1 & ~r1), u0 & u1, v, nAll,
+                                 cubes);
+   return (r0 & ~_truthVar[v]) | (r1 & _truthVar[v]) | r2;
+}
+
+// Depth-optimal priority-cut mapping followed by area recovery with area
+// flow and exact local area, under the required times of the best depth
+class CirMapper: public CirCutMgr
+{
+public:
+   CirMapper(unsigned k): CirCutMgr(k, 10) {}
+
+   void map(const CirMgr*);
+   unsigned getLutNum() const { return _nLut; }
+   unsigned getDepth() const { return _depth; }
+   void writeBlif(ostream&) const;
+
+protected:
+   void evalCut(unsigned gid, CirCut&);
+   bool cutLess(const CirCut&, const CirCut&) const;
+   void nodeDone(unsigned gid);
+
+private:
+   vector<unsigned>   _arrival;
+   vector<unsigned>   _required;
+   vector<float>      _areaFlow;
+   vector<unsigned>   _mapRef;
+   vector<int>        _best;     // index of the selected cut
+   unsigned           _nLut;
+   unsigned           _depth;
+
+   bool isLeafCut(unsigned gid, const CirCut& c) const {
+      return c._size == 1 && c._leaf[0] == gid;
+   }
+   unsigned cutDelay(const CirCut&) const;
+   float cutAreaFlow(const CirCut&) const;
+   unsigned cutRef(const CirCut&);
+   unsigned cutDeref(const CirCut&);
+   const CirCut& bestCut(unsigned gid) const {
+      return getCuts(gid)[_best[gid]];
+   }
+   void computeRequired();
+   void recoverAreaFlow();
+   void recoverExactArea();
+   string uniqueName(const string&, char, unsigned, set<string>&) const;
+};
+
+unsigned
+CirMapper::cutDelay(const CirCut& c) const
+{
+   unsigned d = 0;
+   for (unsigned i = 0; i < c._size; ++i)
+      if (_arrival[c._leaf[i]] > d) d = _arrival[c._leaf[i]];
+   return d + 1;
+}
+
+float
+CirMapper::cutAreaFlow(const CirCut& c) const
+{
+   float a = 1;
+   for (unsigned i = 0; i < c._size; ++i) {
+      const unsigned l = c._leaf[i];
+      const unsigned ref = _mapRef[l] ? _mapRef[l]
+                         : _mgr->getFanoutCsr().size(l);
+      a += _areaFlow[l] / (ref ? ref : 1);
+   }
+   return a;
+}
+
+void
+CirMapper::evalCut(unsigned gid, CirCut& c)
+{
+   if (isLeafCut(gid, c)) { c._delay = 0; c._area = 0; return; }
+   c._delay = cutDelay(c);
+   c._area = cutAreaFlow(c);
+}
+
+bool
+CirMapper::cutLess(const CirCut& a, const CirCut& b) const
+{
+   if (a._delay != b._delay) return a._delay < b._delay;
+   if (a._area != b._area) return a._area < b._area;
+   return a._size < b._size;
+}
+
+void
+CirMapper::nodeDone(unsigned gid)
+{
+   if (_mgr->getGate(gid)->_type != AIG_GATE) return;
+   // the priority cuts are sorted, and the trivial cut is the last one
+   assert(getNumCuts(gid) > 1);
+   _best[gid] = 0;
+   _arrival[gid] = getCuts(gid)[0]._delay;
+   _areaFlow[gid] = getCuts(gid)[0]._area;
+}
+
+// Reference the cover below cut c; return the number of LUTs added
+unsigned
+CirMapper::cutRef(const CirCut& c)
+{
+   unsigned area = 1;
+   for (unsigned i = 0; i < c._size; ++i) {
+      const unsigned l = c._leaf[i];
+      if (_best[l] < 0) continue;
+      if (_mapRef[l]++ == 0) area += cutRef(bestCut(l));
+   }
+   return area;
+}
+
+unsigned
+CirMapper::cutDeref(const CirCut& c)
+{
+   unsigned area = 1;
+   for (unsigned i = 0; i < c._size; ++i) {
+      const unsigned l = c._leaf[i];
+      if (_best[l] < 0) continue;
+      assert(_mapRef[l] > 0);
+      if (--_mapRef[l] == 0) area += cutDeref(bestCut(l));
+   }
+   return area;
+}
+
+// Reference the current cover from the POs and compute the required times
+// for the best depth
+void
+CirMapper::computeRequired()
+{
+   _mapRef.assign(_mapRef.size(), 0);
+   const GateList& po = _mgr->getPOs();
+   _depth = 0;
+   for (size_t i = 0; i < po.size(); ++i) {
+      const unsigned d = po[i]->_fanin[0]->_id;
+      if (_arrival[d] > _depth) _depth = _arrival[d];
+   }
+   _nLut = 0;
+   for (size_t i = 0; i < po.size(); ++i) {
+      const unsigned d = po[i]->_fanin[0]->_id;
+      if (_best[d] >= 0 && _mapRef[d]++ == 0) _nLut += cutRef(bestCut(d));
+   }
+   _required.assign(_required.size(), UINT_MAX);
+   for (size_t i = 0; i < po.size(); ++i)
+      _required[po[i]->_fanin[0]->_id] = _depth;
+   for (size_t i = _order.size(); i-- > 0; ) {
+      const unsigned gid = _order[i]->_id;
+      if (_best[gid] < 0 || !_mapRef[gid]) continue;
+      const CirCut& c = bestCut(gid);
+      for (unsigned j = 0; j < c._size; ++j)
+         if (_required[c._leaf[j]] > _required[gid] - 1)
+            _required[c._leaf[j]] = _required[gid] - 1;
+   }
+}
+
+void
+CirMapper::recoverAreaFlow()
+{
+   for (size_t i = 0; i < _order.size(); ++i) {
+      const unsigned gid = _order[i]->_id;
+      if (_best[gid] < 0) continue;
+      CirCut* cuts = _slot[gid];
+      int best = -1;
+      for (unsigned c = 0; c < _num[gid]; ++c) {
+         if (isLeafCut(gid, cuts[c])) continue;
+         cuts[c]._delay = cutDelay(cuts[c]);
+         cuts[c]._area = cutAreaFlow(cuts[c]);
+         if (cuts[c]._delay > _required[gid]) continue;
+         if (best < 0 || cuts[c]._area < cuts[best]._area ||
+             (cuts[c]._area == cuts[best]._area &&
+              cuts[c]._delay < cuts[best]._delay)) best = c;
+      }
+      if (best < 0) best = _best[gid];   // keep the current one
+      _best[gid] = best;
+      _arrival[gid] = cutDelay(cuts[best]);
+      _areaFlow[gid] = cutAreaFlow(cuts[best]);
+   }
+}
+
+void
+CirMapper::recoverExactArea()
+{
+   for (size_t i = 0; i < _order.size(); ++i) {
+      const unsigned gid = _order[i]->_id;
+      if (_best[gid] < 0) continue;
+      CirCut* cuts = _slot[gid];
+      if (!_mapRef[gid]) {
+         _arrival[gid] = cutDelay(cuts[_best[gid]]);
+         continue;
+      }
+      cutDeref(cuts[_best[gid]]);
+      int best = -1;
+      unsigned bestArea = UINT_MAX, bestDelay = UINT_MAX;
+      for (unsigned c = 0; c < _num[gid]; ++c) {
+         if (isLeafCut(gid, cuts[c])) continue;
+         const unsigned delay = cutDelay(cuts[c]);
+         if (delay > _required[gid]) continue;
+         const unsigned area = cutRef(cuts[c]);
+         cutDeref(cuts[c]);
+         if (area < bestArea || (area == bestArea && delay < bestDelay)) {
+            best = c; bestArea = area; bestDelay = delay;
+         }
+      }
+      if (best >= 0) _best[gid] = best;
+      cutRef(cuts[_best[gid]]);
+      _arrival[gid] = cutDelay(cuts[_best[gid]]);
+   }
+}
+
+void
+CirMapper::map(const CirMgr* mgr)
+{
+   const unsigned nIds = mgr->getGateIdEnd();
+   _arrival.assign(nIds, 0);
+   _required.assign(nIds, UINT_MAX);
+   _areaFlow.assign(nIds, 0);
+   _mapRef.assign(nIds, 0);
+   _best.assign(nIds, -1);
+
+   enumerate(mgr);          // depth-optimal selection in nodeDone()
+   computeRequired();
+   recoverAreaFlow();
+   computeRequired();
+   for (unsigned i = 0; i < 2; ++i) {
+      recoverExactArea();
+      computeRequired();
+   }
+}
+
+// A symbolic name is kept if it is unique among the I/Os; other signals
+// are named i<index>, o<index> and n<gate id>, made unique as well
+string
+CirMapper::uniqueName(const string& sym, char prefix, unsigned n,
+                      set<string>& used) const
+{
+   if (sym != "" && used.insert(sym).second) return sym;
+   ostringstream ss;
+   ss << prefix << n;
+   string name = ss.str();
+   while (!used.insert(name).second) name += '_';
+   return name;
+}
+
+void
+CirMapper::writeBlif(ostream& os) const
+{
+   const GateList& pi = _mgr->getPIs();
+   const GateList& po = _mgr->getPOs();
+   set<string> used;
+   vector<string> name(_best.size()), poName(po.size());
+   for (size_t i = 0; i < pi.size(); ++i)
+      name[pi[i]->_id] = uniqueName(pi[i]->_name, 'i', i, used);
+   for (size_t i = 0; i < po.size(); ++i)
+      poName[i] = uniqueName(po[i]->_name, 'o', i, used);
+   for (size_t i = 0; i < _order.size(); ++i) {
+      const unsigned gid = _order[i]->_id;
+      if (name[gid] == "") name[gid] = uniqueName("", 'n', gid, used);
+   }
+
+   os << ".model cirMap" << endl;
+   os << ".inputs";
+   for (size_t i = 0; i < pi.size(); ++i) os << ' ' << name[pi[i]->_id];
+   os << endl << ".outputs";
+   for (size_t i = 0; i < po.size(); ++i) os << ' ' << poName[i];
+   os << endl;
+
+   // floating gates are constant 0
+   vector<char> floating(_best.size(), 0);
+   for (size_t i = 0; i < _order.size(); ++i) {
+      const unsigned gid = _order[i]->_id;
+      if (_best[gid] < 0 || !_mapRef[gid]) continue;
+      const CirCut& c = bestCut(gid);
+      for (unsigned j = 0; j < c._size; ++j)
+         if (_mgr->getGate(c._leaf[j])->_type == UNDEF_GATE &&
+             !floating[c._leaf[j]]) {
+            floating[c._leaf[j]] = 1;
+            os << ".names " << name[c._leaf[j]] << endl;
+         }
+   }
+
+   vector<string> cubes;
+   for (size_t i = 0; i < _order.size(); ++i) {
+      const unsigned gid = _order[i]->_id;
+      if (_best[gid] < 0 || !_mapRef[gid]) continue;
+      const CirCut& c = bestCut(gid);
+      os << ".names";
+      for (unsigned j = 0; j < c._size; ++j) os << ' ' << name[c._leaf[j]];
+      os << ' ' << name[gid] << endl;
+      cubes.clear();
+      truthIsop(c._truth, c._truth, c._size, c._size, cubes);
+      for (size_t j = 0; j < cubes.size(); ++j)
+         os << cubes[j] << (c._size ? " " : "") << "1" << endl;
+   }
+   // the PO buffers/inverters, and constant drivers
+   for (size_t i = 0; i < po.size(); ++i) {
+      const CirGate* d = po[i]->_fanin[0];
+      const bool inv = po[i]->_invert[0];
+      if (d->_type == CONST_GATE || d->_type == UNDEF_GATE) {
+         os << ".names " << poName[i] << endl;
+         if (inv) os << "1" << endl;
+         continue;
+      }
+      os << ".names " << name[d->_id] << ' ' << poName[i] << endl;
+      os << (inv ? "0 1" : "1 1") << endl;
+   }
+   os << ".end" << endl;
+}
+
+/**************************************************************/
+/*   class CirMgr member functions for technology mapping     */
+/**************************************************************/
+void
+CirMgr::mapLut(unsigned k, ostream* blif) const
+{
+  CirMapper mapper(k);
+  mapper.map(this);
+  cout << "Mapping: " << mapper.getLutNum() << " LUT(s) of at most " << k
+       << " input(s), depth " << mapper.getDepth() << endl;
+  if (blif) mapper.writeBlif(*blif);
+}
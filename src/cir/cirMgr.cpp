@@ -9,14 +9,18 @@
 #include <iostream>
 #include <iomanip>
 #include <cstdio>
+#include <cstdlib>
 #include <ctype.h>
 #include <cassert>
 #include <cstring>
 #include <sstream>
 #include <algorithm>
+#include <functional>
+#include <thread>
 #include "cirMgr.h"
 #include "cirGate.h"
 #include "util.h"
+#include "myWriter.h"
 
 using namespace std;
 
@@ -26,6 +30,7 @@ using namespace std;
 /*   Global variable and enum  */
 /*******************************/
 CirMgr* cirMgr = 0;
+map<string, CirMgr*> cirWorkspace;
 
 enum CirParseError {
    EXTRA_SPACE,
@@ -147,124 +152,338 @@ parseError(CirParseError err)
    return false;
 }
 
+// The AND section is parsed by up to PARSE_MAX_THREADS threads, each on a
+// chunk of at least PARSE_GRAIN lines
+static const size_t   PARSE_GRAIN       = 1 << 16;
+static const unsigned PARSE_MAX_THREADS = 8;
+
+// Run task(0), ..., task(n - 1) concurrently; task 0 runs on this thread
+static void
+runParallel(unsigned n, const function<void(unsigned)>& task)
+{
+   vector<thread> workers;
+   for (unsigned t = 1; t < n; ++t)
+      workers.push_back(thread(task, t));
+   task(0);
+   for (size_t t = 0; t < workers.size(); ++t)
+      workers[t].join();
+}
+
+// Get the next non-empty line [b, e) and move p beyond it
+static bool
+nextLine(const char*& p, const char* end, const char*& b, const char*& e)
+{
+   while (p < end && *p == '\n') ++p;
+   if (p == end) return false;
+   b = p;
+   e = (const char*)memchr(p, '\n', end - p);
+   if (!e) e = end;
+   p = (e == end) ? end : e + 1;
+   return true;
+}
+
+// The aag file is read in blocks of PARSE_BLOCK bytes; the lines of a block
+// are available until the next fill(), which keeps only the partial line
+static const size_t   PARSE_BLOCK       = 1 << 20;
+
+class AagFile
+{
+public:
+   AagFile(const string& fileName)
+      : _file(fileName.c_str(), ios::in | ios::binary), _pos(0), _lines(0),
+        _eof(false) {}
+
+   bool isOpen() const { return _file.is_open(); }
+
+   // The whole lines not consumed yet
+   const char* begin() const { return _buf.data() + _pos; }
+   const char* end() const { return _buf.data() + _lines; }
+   void consume(const char* p) { _pos = p - _buf.data(); }
+
+   // Read up to the last newline of the next block (or of the file);
+   // false if nothing is left
+   bool fill() {
+      _buf.erase(0, _lines);
+      _pos = _lines = 0;
+      while (!_eof) {
+         const size_t n = _buf.size();
+         _buf.resize(n + PARSE_BLOCK);
+         _file.read(&_buf[n], PARSE_BLOCK);
+         _buf.resize(n + _file.gcount());
+         _eof = !_file;
+         const size_t nl = _buf.rfind('\n');
+         if (nl != string::npos) { _lines = nl + 1; return true; }
+      }
+      _lines = _buf.size();
+      return _lines > 0;
+   }
+
+   bool nextLine(const char*& b, const char*& e) {
+      for (;;) {
+         const char* p = begin();
+         if (::nextLine(p, end(), b, e)) { consume(p); return true; }
+         if (!fill()) return false;
+      }
+   }
+
+private:
+   ifstream   _file;
+   string     _buf;
+   size_t     _pos;     // consumed bytes of _buf
+   size_t     _lines;   // bytes of _buf up to the last newline
+   bool       _eof;
+};
+
+// The leading number of each space-separated token in [b, e), as atof()
+// on the token would give for a literal
+static size_t
+lineNums(const char* b, const char* e, unsigned* nums, size_t maxNums)
+{
+   size_t n = 0;
+   while (n < maxNums) {
+      while (b < e && *b == ' ') ++b;
+      if (b == e) break;
+      unsigned v = 0;
+      for (; b < e && isdigit(*b); ++b) v = v * 10 + (*b - '0');
+      nums[n++] = v;
+      while (b < e && *b != ' ') ++b;
+   }
+   return n;
+}
+
+// Write the decimal digits of v at p; return the end of them
+static char*
+putNum(char* p, unsigned v)
+{
+   char d[10];
+   size_t n = 0;
+   do { d[n++] = char('0' + v % 10); v /= 10; } while (v);
+   while (n) *p++ = d[--n];
+   return p;
+}
+
+// Format the AND lines of ands[b, e) into buf; return the number of bytes.
+// buf must hold AAG_AND_LINE_MAX bytes per gate.
+static const size_t AAG_AND_LINE_MAX = 3 * 11;
+
+static size_t
+formatAnds(const GateList& ands, size_t b, size_t e, char* buf)
+{
+   char* p = buf;
+   for (size_t i = b; i < e; ++i) {
+      const CirGate* g = ands[i];
+      p = putNum(p, g->_id * 2);
+      *p++ = ' ';
+      p = putNum(p, g->_fanin[0]->_id * 2 + (g->_invert[0]? 1 : 0));
+      *p++ = ' ';
+      p = putNum(p, g->_fanin[1]->_id * 2 + (g->_invert[1]? 1 : 0));
+      *p++ = '\n';
+   }
+   return p - buf;
+}
+
 /**************************************************************/
 /*   class CirMgr member functions for circuit construction   */
 /**************************************************************/
+CirMgr::~CirMgr()
+{
+  clearTiming();
+  clearSnapshots();
+  for (map<unsigned, CirGate*>::iterator it = _map.begin(); it != _map.end(); ++it)
+    delete it->second;
+  for (size_t i = 0; i < _garbage.size(); i++)
+    delete _garbage[i];
+}
+
 bool
 CirMgr::readCircuit(const string& fileName)
 {
-  // Open the aag file, parse the content and store each line string into circuit
-  ifstream file(fileName.c_str());
-	if (!file.is_open())	return false;
-	string line;
-	vector<string> circuit;
-
-  while(!file.eof()) {
-    getline(file,line,'\n');
-    if (line != "") circuit.push_back(line);
-  }
-	if (circuit.empty())	return false;
+  // a valid image of the same file content skips the parsing
+  CirCacheKey key;
+  const bool keyed = _cacheEnabled && cacheKey(fileName, key);
+  if (keyed && loadCache(fileName, key)) return true;
+
+  // Read the aag file by blocks; empty lines are skipped throughout
+  MY_PERF_SCOPE(perf, "read/file");
+  AagFile file(fileName);
+  if (!file.isOpen()) return false;
+  const char *b, *e;
+  if (!file.nextLine(b, e)) return false;
+  _fileName = fileName;
 
   // Parse the header and init _pi _po _aig
-  if (!lexAig(circuit[0], _header)) {
+  if (!lexAig(string(b, e), _header) || _header.size() < 6) {
     return false;
   }
 
-  int maxId = atof(_header[1].c_str());
-  int piLength = atof(_header[2].c_str());
-  int poLength = atof(_header[4].c_str());
-  int aigLength = atof(_header[5].c_str());
+  const unsigned maxId = atof(_header[1].c_str());
+  const size_t piLength = atof(_header[2].c_str());
+  const size_t poLength = atof(_header[4].c_str());
+  const size_t aigLength = atof(_header[5].c_str());
+  MY_PERF_GATES(perf, aigLength);
+
+  vector<unsigned> piLit(piLength), poLit(poLength);
+  for (size_t i = 0; i < piLength; i++) {
+    if (!file.nextLine(b, e)) return false;
+    lineNums(b, e, &piLit[i], 1);
+  }
+  for (size_t i = 0; i < poLength; i++) {
+    if (!file.nextLine(b, e)) return false;
+    lineNums(b, e, &poLit[i], 1);
+  }
 
+  // add AIG_GATE, a block at a time.  Each block is split into chunks at
+  // newlines, and each chunk counts its lines first, so that it knows the
+  // index of its first AND line.
+  MY_PERF_NEXT(perf, "read/parse");
+  unsigned nChunks = min<size_t>(aigLength / PARSE_GRAIN + 1, PARSE_MAX_THREADS);
+  nChunks = max(1u, min(nChunks, thread::hardware_concurrency()));
   _pi.resize(piLength);
   _po.resize(poLength);
-  _aig.resize(aigLength);
+  _aig.assign(aigLength, 0);
+  vector<unsigned> lits(3 * aigLength);
+  vector<char> bad(nChunks, 0);
+  vector<unsigned> maxVar(nChunks, 0);
+  size_t nParsed = 0;
+  while (nParsed < aigLength && find(bad.begin(), bad.end(), 1) == bad.end()) {
+    if (file.begin() == file.end() && !file.fill()) break;
+    const char* const p = file.begin();
+    const char* const end = file.end();
+    vector<const char*> cut(nChunks + 1, end);
+    cut[0] = p;
+    for (unsigned c = 1; c < nChunks; c++) {
+      const char* q = max(cut[c - 1], p + (end - p) / nChunks * c);
+      q = (const char*)memchr(q, '\n', end - q);
+      cut[c] = q ? q + 1 : end;
+    }
+    vector<size_t> first(nChunks + 1, 0);
+    runParallel(nChunks, [&](unsigned c) {
+      const char *q = cut[c], *lb, *le;
+      size_t n = 0;
+      while (nextLine(q, cut[c + 1], lb, le)) n++;
+      first[c + 1] = n;
+    });
+    first[0] = nParsed;
+    for (unsigned c = 0; c < nChunks; c++) first[c + 1] += first[c];
+
+    const char* symbols = end;
+    runParallel(nChunks, [&](unsigned c) {
+      const char *q = cut[c], *lb, *le;
+      for (size_t i = first[c]; i < aigLength && nextLine(q, cut[c + 1], lb, le); i++) {
+        unsigned* l = &lits[3 * i];
+        if (lineNums(lb, le, l, 3) != 3) { bad[c] = 1; return; }
+        maxVar[c] = max(maxVar[c], max(l[0], max(l[1], l[2])) / 2);
+        _aig[i] = new CirAigGate(l[0] / 2, i + piLength + poLength + 2);
+        if (i == aigLength - 1) symbols = q;
+      }
+    });
+    file.consume(symbols);
+    nParsed = min(first[nChunks], aigLength);
+  }
+  if (nParsed < aigLength || find(bad.begin(), bad.end(), 1) != bad.end()) {
+    for (size_t i = 0; i < aigLength; i++) delete _aig[i];
+    clearList(_aig);
+    return false;
+  }
+
+  // Gates by id; a later definition of an id replaces the earlier one
+  MY_PERF_NEXT(perf, "read/build");
+  unsigned nIds = maxId + poLength + 1;
+  for (unsigned c = 0; c < nChunks; c++) nIds = max(nIds, maxVar[c] + 1);
+  for (size_t i = 0; i < piLength; i++) nIds = max(nIds, piLit[i] / 2 + 1);
+  for (size_t i = 0; i < poLength; i++) nIds = max(nIds, poLit[i] / 2 + 1);
+  GateList byId(nIds, 0);
 
   // add CONST_GATE
-  _map[0] = new CirConstGate();
+  byId[0] = new CirConstGate();
 
   // add PI_GATE
   for (size_t i = 0; i < piLength; i++) {
-    _pi[i] = new CirPiGate(atof(circuit[i+1].c_str())/2, i+2);
-    _map[atof(circuit[i+1].c_str())/2] = _pi[i];
-  }
-
-  // add AIG_GATE
-  for (size_t i = 0; i < aigLength; i++) {
-    vector<string> newAig;
-    if (!lexAig(circuit[i+piLength+poLength+1], newAig)) {
-      return false;
-    }
-    _aig[i] = new CirAigGate(atof(newAig[0].c_str())/2, i+piLength+poLength+2);
-    _map[atof(newAig[0].c_str())/2] = _aig[i];
+    _pi[i] = new CirPiGate(piLit[i] / 2, i + 2);
+    byId[piLit[i] / 2] = _pi[i];
   }
+  for (size_t i = 0; i < aigLength; i++)
+    byId[_aig[i]->_id] = _aig[i];
 
   // add PO_GATE
   for (size_t i = 0; i < poLength; i++) {
-    _po[i] = new CirPoGate(maxId+i+1, i+piLength+2);
-    _map[maxId+i+1] = _po[i];
+    _po[i] = new CirPoGate(maxId + i + 1, i + piLength + 2);
+    byId[maxId + i + 1] = _po[i];
   }
 
-  // handle AIG_GATE fanin and fanout
-  for (size_t i = 0; i < aigLength; i++) {
-    vector<string> newAig;
-    if (!lexAig(circuit[i+piLength+poLength+1], newAig)) {
-      return false;
+  // floating fanins
+  for (size_t i = 0; i < aigLength; i++)
+    for (size_t j = 1; j < 3; j++) {
+      const unsigned v = lits[3 * i + j] / 2;
+      if (!byId[v]) byId[v] = new CirUndefGate(v);
     }
-
-    for (size_t index = 1; index < 3; index++) {
-      // check inverted
-      if (int(atof(newAig[index].c_str())) % 2 == 0) {
-        _aig[i]->setBool(false);
-        map<unsigned, CirGate*>::iterator it = _map.find(atof(newAig[index].c_str())/2);
-        // check floating
-        if (it == _map.end()) {
-          _map[atof(newAig[index].c_str())/2] = new CirUndefGate(atof(newAig[index].c_str())/2);
-        }
-        _aig[i]->setFanin(_map[atof(newAig[index].c_str())/2]);
-        _map[atof(newAig[index].c_str())/2]->setFanout(_aig[i]);
-      } else {
-        _aig[i]->setBool(true);
-        map<unsigned, CirGate*>::iterator it = _map.find((atof(newAig[index].c_str())-1)/2);
-        // check floating
-        if (it == _map.end()) {
-          _map[(atof(newAig[index].c_str())-1)/2] = new CirUndefGate((atof(newAig[index].c_str())-1)/2);
-        }
-        _aig[i]->setFanin(_map[(atof(newAig[index].c_str())-1)/2]);
-        _map[(atof(newAig[index].c_str())-1)/2]->setFanout(_aig[i]);
+  for (size_t i = 0; i < poLength; i++) {
+    const unsigned v = poLit[i] / 2;
+    if (!byId[v]) byId[v] = new CirUndefGate(v);
+  }
+  for (unsigned id = 0; id < nIds; id++)
+    if (byId[id]) _map.insert(_map.end(), make_pair(id, byId[id]));
+
+  // handle AIG_GATE fanin, and count the fanouts of each gate
+  vector<size_t> range(nChunks + 1);
+  for (unsigned c = 0; c <= nChunks; c++) range[c] = aigLength * c / nChunks;
+  vector<atomic<unsigned> > count(nIds);
+  runParallel(nChunks, [&](unsigned c) {
+    for (size_t i = range[c]; i < range[c + 1]; i++)
+      for (size_t j = 1; j < 3; j++) {
+        const unsigned l = lits[3 * i + j];
+        _aig[i]->setFanin(byId[l / 2]);
+        _aig[i]->setBool(l & 1);
+        count[l / 2].fetch_add(1, memory_order_relaxed);
       }
-    }
+  });
+  for (size_t i = 0; i < poLength; i++) {
+    _po[i]->setFanin(byId[poLit[i] / 2]);
+    _po[i]->setBool(poLit[i] & 1);
+    count[poLit[i] / 2].fetch_add(1, memory_order_relaxed);
   }
 
-  // handle PO_GATE fanin
-  for (size_t i = 0; i < poLength; i++) {
-    if (int(atof(circuit[i+piLength+1].c_str())) % 2 == 0) {
-      _map[maxId+i+1]->setBool(false);
-      map<unsigned, CirGate*>::iterator it = _map.find(atof(circuit[i+piLength+1].c_str())/2);
-      if (it == _map.end()) {
-        _map[atof(circuit[i+piLength+1].c_str())/2] = new CirUndefGate(atof(circuit[i+piLength+1].c_str())/2);
-      }
-      _map[maxId+i+1]->setFanin(_map[atof(circuit[i+piLength+1].c_str())/2]);
-      _map[atof(circuit[i+piLength+1].c_str())/2]->setFanout(_map[maxId+i+1]);
-    } else {
-      _map[maxId+i+1]->setBool(true);
-      map<unsigned, CirGate*>::iterator it = _map.find((atof(circuit[i+piLength+1].c_str())-1)/2);
-      if (it == _map.end()) {
-        _map[(atof(circuit[i+piLength+1].c_str())+1)/2] = new CirUndefGate((atof(circuit[i+piLength+1].c_str())-1)/2);
-      }
-      _map[maxId+i+1]->setFanin(_map[(atof(circuit[i+piLength+1].c_str())-1)/2]);
-      _map[(atof(circuit[i+piLength+1].c_str())-1)/2]->setFanout(_map[maxId+i+1]);
+  // count then becomes the next free slot of each fanout list.  Chunks
+  // take the slots in any order, so with more than one chunk each list is
+  // sorted back into the order of AIGs and then POs.
+  runParallel(nChunks, [&](unsigned c) {
+    for (size_t id = nIds * size_t(c) / nChunks; id < nIds * size_t(c + 1) / nChunks; id++) {
+      const unsigned n = count[id].load(memory_order_relaxed);
+      if (n) byId[id]->_fanout.resize(n);
+      count[id].store(0, memory_order_relaxed);
     }
+  });
+  runParallel(nChunks, [&](unsigned c) {
+    for (size_t i = range[c]; i < range[c + 1]; i++)
+      for (size_t j = 1; j < 3; j++) {
+        const unsigned v = lits[3 * i + j] / 2;
+        byId[v]->_fanout[count[v].fetch_add(1, memory_order_relaxed)] = _aig[i];
+      }
+  });
+  for (size_t i = 0; i < poLength; i++) {
+    const unsigned v = poLit[i] / 2;
+    byId[v]->_fanout[count[v].fetch_add(1, memory_order_relaxed)] = _po[i];
   }
+  if (nChunks > 1) runParallel(nChunks, [&](unsigned c) {
+    for (size_t id = nIds * size_t(c) / nChunks; id < nIds * size_t(c + 1) / nChunks; id++)
+      if (byId[id] && byId[id]->_fanout.size() > 1)
+        sort(byId[id]->_fanout.begin(), byId[id]->_fanout.end(),
+             [](const CirGate* x, const CirGate* y) {
+               if (x->_type != y->_type) return y->_type == PO_GATE;
+               return x->_lineNo < y->_lineNo;
+             });
+  });
 
   // setName
-  int nameLine = piLength+poLength+aigLength+1;
-  while (nameLine < circuit.size()) {
-    if (circuit[nameLine] == "c") {
+  MY_PERF_NEXT(perf, "read/names");
+  while (file.nextLine(b, e)) {
+    const string line(b, e);
+    if (line == "c") {
       break;
     }
-    else if (circuit[nameLine][0] == 'i') {
+    else if (line[0] == 'i') {
       vector<string> newName;
-      if (!lexAig(circuit[nameLine], newName)) {
+      if (!lexAig(line, newName)) {
         return false;
       }
       int index;
@@ -274,9 +493,9 @@ CirMgr::readCircuit(const string& fileName)
       ss >> index;
       _pi[index]->setName(newName[1]);
     }
-    else if (circuit[nameLine][0] == 'o') {
+    else if (line[0] == 'o') {
       vector<string> newName;
-      if (!lexAig(circuit[nameLine], newName)) {
+      if (!lexAig(line, newName)) {
         return false;
       }
       int index;
@@ -286,7 +505,10 @@ CirMgr::readCircuit(const string& fileName)
       ss >> index;
       _po[index]->setName(newName[1]);
     }
-    nameLine++;
+  }
+  if (keyed) {
+    MY_PERF_NEXT(perf, "read/cache");
+    saveCache(fileName, key);
   }
   return true;
 }
@@ -306,32 +528,33 @@ Circuit Statistics
 void
 CirMgr::printSummary() const
 {
+  MyWriter out(cout);
   unsigned int sum = _pi.size() + _po.size() + _aig.size();
-  cout << "Circuit Statistics" << endl;
-  cout << "==================" << endl;
-  cout << "  PI    " << setw(8) << right << _pi.size() << endl;
-  cout << "  PO    " << setw(8) << right << _po.size() << endl;
-  cout << "  AIG   " << setw(8) << right << _aig.size() << endl;
-  cout << "------------------" << endl;
-  cout << "  Total " << setw(8) << right << sum << endl;
+  out << "Circuit Statistics" << '\n';
+  out << "==================" << '\n';
+  out << "  PI    ";
+  out.right(_pi.size(), 8) << '\n';
+  out << "  PO    ";
+  out.right(_po.size(), 8) << '\n';
+  out << "  AIG   ";
+  out.right(_aig.size(), 8) << '\n';
+  out << "------------------" << '\n';
+  out << "  Total ";
+  out.right(sum, 8) << '\n';
 }
 
 void
 CirMgr::printNetlist() const
 {
-  GateList dfsTl;
+  MyWriter out(cout);
+  const GateList& dfsTl = getDfsList();
 
-  CirGate::setGlobalRef();
-  for (size_t i = 0; i < _po.size(); i++) {
-    _po[i]->dfsTraversal(dfsTl);
-  }
-
-  cout << endl;
+  out << '\n';
   unsigned undefNum = 0;
   for (size_t i = 0; i < dfsTl.size(); i++) {
     if (dfsTl[i]->_type == PI_GATE) {
-      cout << "[" << i-undefNum << "] "<< "PI  "<< dfsTl[i]->_id //<< " (" << dfsTl[i]->_name << ")"
-      << endl;
+      out << "[" << i-undefNum << "] "<< "PI  "<< dfsTl[i]->_id //<< " (" << dfsTl[i]->_name << ")"
+      << '\n';
     } else if (dfsTl[i]->_type == PO_GATE) {
       string invert = "";
       string floating = "";
@@ -341,8 +564,8 @@ CirMgr::printNetlist() const
       if (dfsTl[i]->_fanin[0]->checkFloat()) {
         floating = "*";
       }
-      cout << "[" << i-undefNum << "] "<< "PO  "<< dfsTl[i]->_id << " " << floating << invert << dfsTl[i]->_fanin[0]->_id //<< " (" << dfsTl[i]->_name << ")"
-      << endl;
+      out << "[" << i-undefNum << "] "<< "PO  "<< dfsTl[i]->_id << " " << floating << invert << dfsTl[i]->_fanin[0]->_id //<< " (" << dfsTl[i]->_name << ")"
+      << '\n';
     } else if (dfsTl[i]->_type == AIG_GATE) {
       string invertOne = "";
       string floatingOne = "";
@@ -360,10 +583,10 @@ CirMgr::printNetlist() const
       if (dfsTl[i]->_fanin[1]->_type == UNDEF_GATE) {
         floatingTwo = "*";
       }
-      cout << "[" << i-undefNum << "] "<< "AIG "<< dfsTl[i]->_id << " " << floatingOne << invertOne << dfsTl[i]->_fanin[0]->_id
-       << " " << floatingTwo << invertTwo << dfsTl[i]->_fanin[1]->_id << endl;
+      out << "[" << i-undefNum << "] "<< "AIG "<< dfsTl[i]->_id << " " << floatingOne << invertOne << dfsTl[i]->_fanin[0]->_id
+       << " " << floatingTwo << invertTwo << dfsTl[i]->_fanin[1]->_id << '\n';
     } else if (dfsTl[i]->_type == CONST_GATE) {
-      cout << "[" << i-undefNum << "] "<< "CONST0" << endl;
+      out << "[" << i-undefNum << "] "<< "CONST0" << '\n';
     } else {
       undefNum++;
     }
@@ -373,38 +596,41 @@ CirMgr::printNetlist() const
 void
 CirMgr::printPIs() const
 {
-   cout << "PIs of the circuit:";
+   MyWriter out(cout);
+   out << "PIs of the circuit:";
    for (size_t i = 0; i < _pi.size(); i++) {
-     cout << ' ' << _pi[i]->_id;
+     out << ' ' << _pi[i]->_id;
    }
-   cout << endl;
+   out << '\n';
 }
 
 void
 CirMgr::printPOs() const
 {
-   cout << "POs of the circuit:";
+   MyWriter out(cout);
+   out << "POs of the circuit:";
    for (size_t i = 0; i < _po.size(); i++) {
-     cout << ' ' << _po[i]->_id;
+     out << ' ' << _po[i]->_id;
    }
-   cout << endl;
+   out << '\n';
 }
 
 void
 CirMgr::printFloatGates() const
 {
+  MyWriter out(cout);
   bool floating = false;
   for (size_t i = 0; i < _aig.size(); i++) {
     if (_aig[i]->checkFloat()) {
       if (floating == false) {
-        cout << "Gates with floating fanin(s):";
+        out << "Gates with floating fanin(s):";
         floating = true;
       }
-      cout << ' ' << _aig[i]->_id;
+      out << ' ' << _aig[i]->_id;
     }
   }
   if (floating == true) {
-    cout << endl;
+    out << '\n';
   }
 
   vector<unsigned> dnuGate;
@@ -420,64 +646,155 @@ CirMgr::printFloatGates() const
     }
   }
   if (dnuGate.size() != 0) {
-    cout << "Gates defined but not used  :";
+    out << "Gates defined but not used  :";
     sort(dnuGate.begin(), dnuGate.end());
     for (size_t i = 0; i < dnuGate.size(); i++) {
-      cout << ' ' << dnuGate[i];
+      out << ' ' << dnuGate[i];
     }
-    cout << endl;
+    out << '\n';
   }
 }
 
 void
 CirMgr::writeAag(ostream& outfile) const
 {
-  GateList dfsTl;
-  CirGate::setGlobalRef();
-  for (size_t i = 0; i < _po.size(); i++) {
-    _po[i]->dfsTraversal(dfsTl);
-  }
-  int aigNum = 0;
+  MyWriter out(outfile);
+  const GateList& dfsTl = getDfsList();
+  GateList ands;
   for (size_t i = 0; i < dfsTl.size(); i++) {
     if (dfsTl[i]->_type == AIG_GATE) {
-      aigNum++;
+      ands.push_back(dfsTl[i]);
+    }
+  }
+  const size_t aigNum = ands.size();
+  // gates created by optimization may have ids beyond the original M
+  unsigned maxVar = atoi(_header[1].c_str());
+  for (size_t i = 0; i < ands.size(); i++) {
+    if (ands[i]->_id > maxVar) {
+      maxVar = ands[i]->_id;
     }
   }
-  outfile << "aag " << _header[1] << " " << _header[2] << " " << _header[3]
-    << " " << _header[4] << " " << aigNum << endl;
+  out << "aag " << maxVar << " " << _header[2] << " " << _header[3]
+    << " " << _header[4] << " " << aigNum << '\n';
 
   for (size_t i = 0; i < _pi.size(); i++) {
-    outfile << _pi[i]->_id * 2 << endl;
+    out << _pi[i]->_id * 2 << '\n';
   }
 
   for (size_t i = 0; i < _po.size(); i++) {
     int num = 0;
     if (_po[i]->_invert[0]) { num = 1; }
-    outfile << _po[i]->_fanin[0]->_id * 2 + (_po[i]->_invert[0]? 1 : 0) << endl;
+    out << _po[i]->_fanin[0]->_id * 2 + (_po[i]->_invert[0]? 1 : 0) << '\n';
   }
 
-  for (size_t i = 0; i < dfsTl.size(); i++) {
-    if (dfsTl[i]->_type == AIG_GATE) {
-      outfile << dfsTl[i]->_id * 2  << " " << dfsTl[i]->_fanin[0]->_id * 2 + (dfsTl[i]->_invert[0]? 1 : 0)
-        << " " << dfsTl[i]->_fanin[1]->_id * 2 + (dfsTl[i]->_invert[1]? 1 : 0) << endl ;
-    }
+  // The AND section is formatted by up to PARSE_MAX_THREADS threads, each
+  // into its own buffer; the buffers are then written in order
+  const unsigned nChunks = min<size_t>(aigNum / PARSE_GRAIN + 1, PARSE_MAX_THREADS);
+  const size_t chunk = (aigNum + nChunks - 1) / nChunks;
+  vector<vector<char> > bufs(nChunks);
+  vector<size_t> lens(nChunks, 0);
+  runParallel(nChunks, [&](unsigned c) {
+    const size_t b = min(aigNum, c * chunk), e = min(aigNum, b + chunk);
+    bufs[c].resize((e - b) * AAG_AND_LINE_MAX);
+    if (e > b) lens[c] = formatAnds(ands, b, e, &bufs[c][0]);
+  });
+  for (unsigned c = 0; c < nChunks; c++) {
+    if (lens[c]) out.write(&bufs[c][0], lens[c]);
+    vector<char>().swap(bufs[c]);
   }
 
   for (size_t i = 0; i < _pi.size(); i++) {
     if (_pi[i]->_name != "") {
-      outfile << "i" << i << " " << _pi[i]->_name << endl;
+      out << "i" << i << " " << _pi[i]->_name << '\n';
     }
   }
   for (size_t i = 0; i < _po.size(); i++) {
     if (_po[i]->_name != "") {
-      outfile << "o" << i << " " << _po[i]->_name << endl;
+      out << "o" << i << " " << _po[i]->_name << '\n';
     }
   }
 
-  outfile << "c" << endl;
-  outfile << "AAG output by Yu An Chan" << endl;
+  out << "c" << '\n';
+  out << "AAG output by Yu An Chan" << '\n';
+}
+
+/************************************************************/
+/*   class CirMgr member functions for circuit traversal    */
+/************************************************************/
+// Topological order of the gates reachable from the POs (fanins first)
+void
+CirMgr::dfsOrder(GateList& dfsTl) const
+{
+  const GateList& dfsList = getDfsList();
+  dfsTl.insert(dfsTl.end(), dfsList.begin(), dfsList.end());
+}
+
+// The same order without the cache; this does not change the circuit, so
+// threads with their own contexts may call it together
+void
+CirMgr::dfsOrder(GateList& dfsTl, CirTravContext& ctx) const
+{
+  MY_PERF_SCOPE(perf, "dfs");
+  ctx.newTrav();
+  for (size_t i = 0; i < _po.size(); i++) {
+    _po[i]->dfsTraversal(dfsTl, ctx);
+  }
+  MY_PERF_GATES(perf, dfsTl.size());
+}
+
+const GateList&
+CirMgr::getDfsList() const
+{
+  if (!_dfsValid) {
+    lock_guard<mutex> lock(_cacheLock);
+    if (_dfsValid) return _dfsList;
+    _dfsList.clear();
+    CirTravContext ctx(getGateIdEnd());
+    dfsOrder(_dfsList, ctx);
+    _dfsState = _netState;
+    _dfsValid = true;
+  }
+  return _dfsList;
 }
 
+// Two passes over the gates: count the fanouts of each gate, then copy
+// them after the prefix sums of the counts, keeping their order
+const CirFanoutCsr&
+CirMgr::getFanoutCsr() const
+{
+  if (!_csrValid) {
+    lock_guard<mutex> lock(_cacheLock);
+    if (_csrValid) return _fanoutCsr;
+    const unsigned nIds = getGateIdEnd();
+    vector<unsigned>& offset = _fanoutCsr._offset;
+    offset.assign(nIds + 1, 0);
+    map<unsigned, CirGate*>::const_iterator it;
+    for (it = _map.begin(); it != _map.end(); ++it)
+      offset[it->first + 1] = it->second->_fanout.size();
+    for (unsigned id = 0; id < nIds; id++) offset[id + 1] += offset[id];
+
+    _fanoutCsr._edge.resize(offset[nIds]);
+    for (it = _map.begin(); it != _map.end(); ++it) {
+      const CirGate* g = it->second;
+      CirGateV* edge = _fanoutCsr._edge.data() + offset[it->first];
+      for (size_t i = 0; i < g->_fanout.size(); i++) {
+        // the fanin of fo from g; a fanout with both fanins from g is
+        // listed twice, and its first entry takes fanin 0
+        CirGate* fo = g->_fanout[i];
+        size_t j = 0;
+        while (j < fo->_fanin.size() && fo->_fanin[j] != g) j++;
+        if (j + 1 < fo->_fanin.size() && fo->_fanin[j + 1] == g &&
+            find(g->_fanout.begin(), g->_fanout.begin() + i, fo) !=
+            g->_fanout.begin() + i)
+          j++;
+        edge[i] = CirGateV(fo, j < fo->_fanin.size() && fo->_invert[j]);
+      }
+    }
+    _csrState = _netState;
+    _csrValid = true;
+  }
+  return _fanoutCsr;
+}
 
 bool
 CirMgr::lexAig(const string& option, vector<string>& tokens) const
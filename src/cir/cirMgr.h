@@ -14,20 +14,82 @@
 #include <fstream>
 #include <iostream>
 #include <map>
+#include <unordered_map>
+#include <stdint.h>
+#include <climits>
+#include <atomic>
+#include <mutex>
 
 
 using namespace std;
 
 #include "cirDef.h"
+#include "cirGate.h"
 
 extern CirMgr *cirMgr;
+// All the resident circuits by design name; cirMgr is the current one
+extern map<string, CirMgr*> cirWorkspace;
+
+// Fanouts of all the gates in compressed sparse row form.  The fanouts of
+// the gate with id i are _edge[_offset[i]] ... _edge[_offset[i + 1] - 1],
+// each with the polarity of the fanin edge from gate i.
+struct CirFanoutCsr
+{
+   vector<unsigned>  _offset;
+   vector<CirGateV>  _edge;
+
+   size_t size(unsigned id) const { return _offset[id + 1] - _offset[id]; }
+   CirGateV edge(unsigned id, size_t i) const { return _edge[_offset[id] + i]; }
+};
+
+// Results of the read-only queries of CirMgr
+struct CirGateInfo
+{
+   GateType   _type;     // TOT_GATE if the gate does not exist
+   unsigned   _id;
+   unsigned   _lineNo;
+   string     _name;
+   unsigned   _nFanin;
+   unsigned   _nFanout;
+};
+
+// One gate of a fanin / fanout cone, in the order of CIRGate reports
+struct CirConeEntry
+{
+   CirConeEntry(const CirGate* g, unsigned d, bool inv, bool elided):
+      _gate(g), _depth(d), _inv(inv), _elided(elided) {}
+
+   const CirGate*  _gate;
+   unsigned        _depth;
+   bool            _inv;      // polarity of the edge it is reached through
+   bool            _elided;   // listed before, so its cone is not repeated
+};
+
+// Delays of the timing analysis by gate type; an inverted fanin edge adds
+// _inv.  The default is the unit delay model, where arrival = depth.
+struct CirDelayModel
+{
+   CirDelayModel(): _pi(0), _aig(1), _po(0), _inv(0) {}
+
+   bool operator == (const CirDelayModel& m) const {
+      return _pi == m._pi && _aig == m._aig && _po == m._po && _inv == m._inv;
+   }
+   bool operator != (const CirDelayModel& m) const { return !(*this == m); }
+
+   double   _pi;    // arrival time of the PIs
+   double   _aig;
+   double   _po;
+   double   _inv;
+};
 
 // TODO: Define your own data members and member functions
 class CirMgr
 {
 public:
-   CirMgr(){}
-   ~CirMgr() {}
+   CirMgr(): _nextId(0), _strashBuilt(false), _cowSerial(0), _netState(0),
+     _nNetStates(0), _dfsValid(false), _dfsState(UINT_MAX), _csrValid(false),
+     _csrState(UINT_MAX), _timing(0) {}
+   ~CirMgr();
 
    // Access functions
    // return '0' if "gid" corresponds to an undefined gate.
@@ -38,9 +100,19 @@ public:
      }
      return it->second;
    }
+   // return one past the largest gate id (including POs)
+   unsigned getGateIdEnd() const {
+     return _map.empty() ? 0 : _map.rbegin()->first + 1;
+   }
+   const GateList& getPIs() const { return _pi; }
+   const GateList& getPOs() const { return _po; }
+   const GateList& getAIGs() const { return _aig; }
+   const string& getFileName() const { return _fileName; }
 
    // Member functions about circuit construction
    bool readCircuit(const string&);
+   // readCircuit() uses and writes the binary cache unless it is disabled
+   static void enableCache(bool on) { _cacheEnabled = on; }
 
    // Member functions about circuit reporting
    void printSummary() const;
@@ -50,6 +122,65 @@ public:
    void printFloatGates() const;
    void writeAag(ostream&) const;
 
+   // Member functions about circuit traversal
+   void dfsOrder(GateList& dfsTl) const;
+   void dfsOrder(GateList& dfsTl, CirTravContext& ctx) const;
+   const GateList& getDfsList() const;
+   const CirFanoutCsr& getFanoutCsr() const;
+
+   // Read-only queries into caller-provided buffers.  They do not change
+   // the circuit, so threads with their own buffers and contexts may run
+   // them together.
+   bool queryGate(unsigned gid, CirGateInfo& info) const;
+   size_t queryGates(const IdList& gids, vector<CirGateInfo>& infos) const;
+   bool queryFanin(unsigned gid, unsigned level, vector<CirConeEntry>& cone,
+                   CirTravContext& ctx) const;
+   bool queryFanout(unsigned gid, unsigned level, vector<CirConeEntry>& cone,
+                    CirTravContext& ctx) const;
+   unsigned getDepth() const;
+
+   // Member functions about netlist editing
+   bool isAlive(const CirGate* g) const { return getGate(g->_id) == g; }
+   CirGateV getConst(bool one = false) const { return CirGateV(getGate(0), one); }
+   void buildStrash();
+   CirGateV findAnd(CirGateV a, CirGateV b) const;
+   CirGateV strashAnd(CirGateV a, CirGateV b);
+   void replaceGate(CirGate* g, CirGateV v);
+   void setFanin(CirGate* g, size_t i, CirGateV v);
+   void deleteUnused(CirGate* g);
+   void cleanGarbage();
+
+   // Member functions about snapshots
+   bool takeSnapshot(const string& name);
+   bool restoreSnapshot(const string& name);
+   void clearSnapshots();
+   void printSnapshots() const;
+   size_t getNumSnapshots() const { return _snapshots.size(); }
+
+   // Member functions about cone extraction
+   bool extractCone(const IdList& poIds, CirMgr& cone) const;
+
+   // Member functions about circuit optimization
+   void rewrite();
+   void balance();
+
+   // Member functions about technology mapping
+   void mapLut(unsigned k, ostream* blif = 0) const;
+
+   // Member functions about equivalence checking
+   void cec(const CirMgr& other) const;
+
+   // Member functions about timing analysis
+   void updateTiming(const CirDelayModel& model);
+   void reportTiming(unsigned nPaths, unsigned nBins, double period) const;
+
+   // Member functions about power estimation
+   void reportPower(size_t nPatterns, unsigned seed, size_t nTop) const;
+
+   // Member functions about fault simulation
+   void faultSim(size_t nPatterns, unsigned seed, unsigned nThreads,
+                 bool listUndetected) const;
+
    // My Func
    bool lexAig(const string& option, vector<string>& tokens) const;
 
@@ -59,6 +190,97 @@ private:
   GateList _aig;
   map<unsigned, CirGate*> _map;
   vector<string> _header;
+  string _fileName;
+
+  unsigned _nextId;
+  bool _strashBuilt;
+  unordered_map<size_t, CirGate*> _strash;
+  GateList _garbage;
+
+  // Copy-on-write journal of a snapshot: the first edit of a gate after the
+  // snapshot saves its connections; the removed gates are kept alive
+  struct CirGateState {
+    CirGate* _gate;
+    GateList _fanin;
+    vector<bool> _invert;
+    GateList _fanout;
+  };
+  struct CirSnapshot {
+    string _name;
+    unsigned _serial;
+    unsigned _nextId;
+    size_t _nAig;
+    bool _aigSaved;
+    GateList _aig;         // _aig before its first compaction
+    vector<CirGateState> _saved;
+    GateList _created;
+    GateList _removed;
+    unsigned _netState;
+    // the strash entries changed since, with their old gates (0: none);
+    // _strashLost if the table has been built again
+    vector<pair<size_t, CirGate*> > _strashLog;
+    bool _strashLost;
+  };
+  vector<CirSnapshot*> _snapshots;
+  unsigned _cowSerial;
+  void logStrash(size_t key, CirGate* old) {
+    if (!_snapshots.empty())
+      _snapshots.back()->_strashLog.push_back(make_pair(key, old));
+  }
+
+  // Every edit gives the netlist a new state id; restoring a snapshot
+  // brings back its id, so the caches built from it are valid again
+  unsigned _netState;
+  unsigned _nNetStates;
+  void netChanged() {
+    _dfsValid = _csrValid = false;
+    _netState = ++_nNetStates;
+  }
+
+  // Caches of this circuit, invalidated by netlist editing.  They are
+  // built under _cacheLock on the first use, which may be from any thread,
+  // and remember the state they are built from.
+  mutable GateList _dfsList;
+  mutable atomic<bool> _dfsValid;
+  mutable unsigned _dfsState;
+  mutable CirFanoutCsr _fanoutCsr;
+  mutable atomic<bool> _csrValid;
+  mutable unsigned _csrState;
+  mutable mutex _cacheLock;
+
+  // Static timing, see cirTiming.cpp.  Once it is built, the gates touched
+  // by netlist editing are recorded, so that updateTiming() only follows
+  // their cones.
+  struct CirTiming;
+  CirTiming* _timing;
+  void timingDirty(const CirGate* g) {
+    if (_timing) _timingDirty.push_back(g->_id);
+  }
+  IdList _timingDirty;
+
+  unsigned newGateId();
+  bool trivialAnd(CirGateV a, CirGateV b, CirGateV& r) const;
+  static size_t strashKey(CirGateV a, CirGateV b);
+  void unhash(CirGate* g);
+  void touch(CirGate* g);
+
+  // Binary image of a parsed circuit, see cirCache.cpp
+  static bool _cacheEnabled;
+  struct CirCacheKey {
+    uint64_t _size;
+    uint64_t _mtime;
+    uint64_t _hash;
+  };
+  static bool cacheKey(const string& fileName, CirCacheKey& key);
+  bool loadCache(const string& fileName, const CirCacheKey& key);
+  void saveCache(const string& fileName, const CirCacheKey& key) const;
+  void undoSnapshot(CirSnapshot* s);
+  void coneIn(const CirGate* g, bool inv, unsigned depth, unsigned level,
+              vector<CirConeEntry>& cone, CirTravContext& ctx) const;
+  void coneOut(const CirGate* g, bool inv, unsigned depth, unsigned level,
+               vector<CirConeEntry>& cone, CirTravContext& ctx) const;
+  void buildTiming();
+  void clearTiming();
 };
 
 #endif // CIR_MGR_H
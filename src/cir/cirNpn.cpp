@@ -0,0 +1,289 @@
+/****************************************************************************
+  FileName     [ cirNpn.cpp ]
+  PackageName  [ cir ]
+  Synopsis     [ Define the 4-input NPN class library ]
+  Author       [ Chung-Yang (Ric) Huang ]
+  Copyright    [ Copyleft(c) 2008-present LaDs(III), GIEE, NTU, Taiwan ]
+****************************************************************************/
+
+#include <cassert>
+#include <atomic>
+#include "cirNpn.h"
+
+using namespace std;
+
+/*******************************/
+/*   Global variable and enum  */
+/*******************************/
+// One entry per NPN class of 4-input functions, sorted by the canonical
+// truth table.  Classes of up to 5 AND nodes are exact minimum (exhaustive
+// enumeration); the others are the smallest of Shannon, AND and XOR
+// decompositions over the exact ones, counted with structural sharing.
+constexpr CirNpnClass _npnLib[NPN_CLASS_NUM] = {
+   { 0x0000,  0,  0, {} },
+   { 0x0001,  3, 14, {{3,7},{5,9},{10,12}} },
+   { 0x0003,  2, 12, {{5,9},{7,10}} },
+   { 0x0006,  5, 18, {{2,4},{3,5},{7,9},{11,13},{14,16}} },
+   { 0x0007,  3, 14, {{7,9},{2,4},{10,13}} },
+   { 0x000F,  1, 10, {{7,9}} },
+   { 0x0016,  7, 22, {{2,6},{3,7},{5,12},{4,13},{9,15},{17,18},{11,20}} },
+   { 0x0017,  5, 18, {{2,4},{3,5},{9,11},{6,13},{14,17}} },
+   { 0x0018,  6, 20, {{3,4},{3,6},{4,7},{13,15},{11,17},{9,18}} },
+   { 0x0019,  5, 18, {{2,5},{2,7},{4,13},{9,11},{15,16}} },
+   { 0x001B,  4, 16, {{3,4},{2,6},{9,11},{13,14}} },
+   { 0x001E,  5, 18, {{3,5},{7,10},{6,11},{9,13},{15,16}} },
+   { 0x001F,  3, 14, {{3,5},{6,11},{9,13}} },
+   { 0x003C,  4, 16, {{5,7},{4,6},{9,11},{13,14}} },
+   { 0x003D,  5, 18, {{5,6},{5,2},{7,13},{11,15},{9,17}} },
+   { 0x003F,  2, 12, {{4,6},{9,11}} },
+   { 0x0069,  7, 22, {{4,7},{5,6},{11,13},{3,14},{2,15},{17,19},{9,21}} },
+   { 0x006B,  7, 22, {{2,7},{3,6},{11,13},{5,13},{4,15},{17,19},{9,21}} },
+   { 0x006F,  5, 18, {{3,4},{2,5},{6,11},{13,14},{9,17}} },
+   { 0x007E,  6, 20, {{2,5},{2,6},{5,7},{13,15},{11,17},{9,19}} },
+   { 0x007F,  3, 14, {{2,6},{4,10},{9,13}} },
+   { 0x00FF,  0,  9, {} },
+   { 0x0116,  9, 27, {{7,9},{2,4},{10,13},{3,5},{6,8},{16,19},{15,20},{14,21},{23,25}} },
+   { 0x0117,  7, 22, {{6,8},{2,4},{3,5},{7,9},{13,16},{15,19},{11,21}} },
+   { 0x0118,  8, 24, {{3,4},{6,8},{11,13},{7,9},{5,16},{2,17},{19,21},{14,22}} },
+   { 0x0119,  7, 23, {{4,9},{7,10},{6,8},{5,15},{3,16},{2,12},{19,21}} },
+   { 0x011A,  7, 23, {{7,9},{6,8},{5,11},{13,14},{3,16},{2,10},{19,21}} },
+   { 0x011B,  6, 21, {{7,9},{6,8},{5,13},{3,14},{2,10},{17,19}} },
+   { 0x011E,  7, 23, {{7,9},{3,5},{6,8},{12,15},{11,16},{10,17},{19,21}} },
+   { 0x011F,  5, 19, {{6,8},{7,9},{3,5},{11,14},{13,17}} },
+   { 0x012C,  8, 25, {{7,9},{3,6},{2,8},{5,13},{15,16},{11,18},{10,19},{21,23}} },
+   { 0x012D,  7, 22, {{4,8},{6,9},{2,5},{6,15},{13,14},{17,19},{11,20}} },
+   { 0x012F,  5, 18, {{5,2},{5,3},{6,11},{8,13},{15,17}} },
+   { 0x013C,  7, 23, {{7,9},{3,7},{8,13},{11,15},{5,16},{4,10},{19,21}} },
+   { 0x013D,  6, 20, {{4,6},{5,7},{2,12},{8,13},{15,17},{11,18}} },
+   { 0x013E,  7, 23, {{4,6},{9,11},{3,7},{5,14},{13,16},{12,17},{19,21}} },
+   { 0x013F,  5, 18, {{5,9},{5,3},{8,13},{6,11},{15,17}} },
+   { 0x0168, 10, 29, {{4,6},{9,11},{2,8},{3,9},{5,7},{15,18},{17,21},{13,23},{12,22},{25,27}} },
+   { 0x0169,  9, 26, {{2,8},{4,7},{4,9},{6,15},{13,17},{3,19},{2,18},{21,23},{11,24}} },
+   { 0x016A,  8, 25, {{4,6},{9,11},{5,7},{8,15},{3,17},{13,18},{12,19},{21,23}} },
+   { 0x016B,  8, 25, {{3,7},{5,10},{4,6},{2,14},{3,15},{9,17},{19,20},{13,23}} },
+   { 0x016E,  8, 24, {{2,6},{4,10},{7,8},{3,5},{8,17},{15,16},{19,21},{13,22}} },
+   { 0x016F,  7, 22, {{2,6},{4,10},{3,5},{6,14},{8,15},{17,19},{13,20}} },
+   { 0x017E,  8, 25, {{2,6},{4,10},{9,13},{3,7},{5,16},{15,18},{14,19},{21,23}} },
+   { 0x017F,  6, 20, {{2,6},{4,10},{3,7},{5,14},{8,17},{13,19}} },
+   { 0x0180,  7, 23, {{4,9},{6,10},{5,8},{7,14},{3,16},{2,12},{19,21}} },
+   { 0x0181,  6, 21, {{4,9},{6,10},{5,7},{3,14},{2,12},{17,19}} },
+   { 0x0182,  8, 24, {{5,6},{5,8},{4,7},{9,15},{2,16},{3,12},{19,21},{11,23}} },
+   { 0x0183,  6, 20, {{5,6},{2,6},{2,8},{4,13},{15,17},{11,18}} },
+   { 0x0186,  9, 27, {{7,9},{3,4},{3,7},{4,9},{15,17},{13,19},{11,20},{10,21},{23,25}} },
+   { 0x0187,  7, 22, {{3,5},{8,11},{2,4},{6,14},{7,15},{17,19},{13,21}} },
+   { 0x0189,  5, 18, {{3,4},{3,7},{4,9},{13,15},{11,17}} },
+   { 0x018B,  5, 18, {{2,4},{2,8},{5,7},{11,15},{13,17}} },
+   { 0x018F,  5, 18, {{2,4},{3,5},{6,11},{8,13},{15,17}} },
+   { 0x0196, 10, 29, {{7,9},{4,9},{6,8},{5,15},{3,16},{2,12},{19,21},{11,23},{10,22},{25,27}} },
+   { 0x0197,  9, 27, {{3,7},{4,8},{10,13},{2,6},{5,16},{4,17},{9,19},{21,22},{15,25}} },
+   { 0x0198,  8, 25, {{4,9},{7,9},{6,8},{5,13},{15,16},{3,18},{2,10},{21,23}} },
+   { 0x0199,  6, 21, {{4,9},{6,8},{5,13},{3,14},{2,10},{17,19}} },
+   { 0x019A,  8, 25, {{3,9},{3,5},{5,6},{8,13},{15,17},{11,18},{10,19},{21,23}} },
+   { 0x019B,  7, 23, {{5,6},{9,11},{6,8},{5,15},{3,16},{2,12},{19,21}} },
+   { 0x019E,  9, 27, {{2,4},{6,11},{9,13},{3,5},{6,8},{16,19},{15,20},{14,21},{23,25}} },
+   { 0x019F,  7, 22, {{6,8},{2,4},{3,5},{6,13},{9,17},{15,19},{11,21}} },
+   { 0x01A8,  6, 20, {{3,9},{5,7},{2,12},{8,13},{15,17},{11,18}} },
+   { 0x01A9,  5, 18, {{2,9},{5,7},{2,12},{11,13},{15,17}} },
+   { 0x01AA,  5, 18, {{3,5},{3,9},{7,10},{8,15},{13,17}} },
+   { 0x01AB,  4, 17, {{3,5},{2,9},{7,10},{13,15}} },
+   { 0x01AC,  7, 22, {{3,6},{3,8},{5,7},{8,15},{13,14},{17,19},{11,20}} },
+   { 0x01AD,  6, 20, {{3,6},{5,7},{3,5},{9,13},{15,17},{11,19}} },
+   { 0x01AE,  6, 20, {{3,6},{3,5},{8,12},{9,13},{15,17},{11,19}} },
+   { 0x01AF,  4, 16, {{3,5},{3,6},{8,11},{13,15}} },
+   { 0x01BC,  8, 24, {{3,5},{8,11},{3,6},{5,9},{6,16},{15,17},{19,21},{13,23}} },
+   { 0x01BD,  7, 22, {{3,6},{4,10},{5,7},{2,14},{8,15},{17,19},{13,20}} },
+   { 0x01BE,  8, 25, {{3,6},{9,11},{3,5},{6,8},{14,17},{13,18},{12,19},{21,23}} },
+   { 0x01BF,  6, 20, {{4,8},{3,4},{3,7},{9,13},{15,17},{11,19}} },
+   { 0x01E8,  8, 24, {{3,9},{4,6},{10,13},{5,7},{2,16},{8,17},{19,21},{15,22}} },
+   { 0x01E9,  8, 24, {{3,6},{5,10},{2,4},{3,5},{7,15},{9,19},{17,21},{13,23}} },
+   { 0x01EA,  7, 23, {{3,7},{5,10},{4,6},{3,15},{9,17},{8,12},{19,21}} },
+   { 0x01EB,  6, 21, {{3,7},{5,10},{4,6},{3,15},{9,17},{13,19}} },
+   { 0x01EE,  5, 18, {{8,7},{3,5},{8,13},{11,12},{15,17}} },
+   { 0x01EF,  4, 16, {{3,5},{6,10},{8,11},{13,15}} },
+   { 0x01FE,  5, 19, {{3,5},{7,10},{8,12},{9,13},{15,17}} },
+   { 0x033C,  6, 21, {{7,9},{6,8},{5,13},{11,14},{10,15},{17,19}} },
+   { 0x033D,  7, 22, {{4,6},{2,9},{5,7},{9,15},{13,14},{17,19},{11,21}} },
+   { 0x033F,  4, 16, {{5,7},{4,6},{8,11},{13,15}} },
+   { 0x0356,  5, 18, {{3,9},{5,7},{10,12},{11,13},{15,17}} },
+   { 0x0357,  3, 15, {{3,9},{5,7},{11,13}} },
+   { 0x0358,  7, 23, {{7,9},{3,9},{5,7},{13,15},{11,17},{10,16},{19,21}} },
+   { 0x0359,  7, 23, {{2,9},{6,8},{4,7},{13,15},{11,16},{10,17},{19,21}} },
+   { 0x035A,  6, 21, {{3,9},{4,8},{11,13},{7,14},{6,10},{17,19}} },
+   { 0x035B,  6, 21, {{3,9},{2,9},{4,13},{7,15},{6,10},{17,19}} },
+   { 0x035E,  7, 23, {{3,9},{2,9},{4,13},{7,15},{11,16},{10,17},{19,21}} },
+   { 0x035F,  4, 17, {{6,2},{7,5},{9,11},{13,15}} },
+   { 0x0368,  8, 25, {{4,6},{9,11},{3,9},{5,7},{15,17},{13,19},{12,18},{21,23}} },
+   { 0x0369,  8, 25, {{2,9},{4,7},{4,9},{6,15},{13,17},{11,18},{10,19},{21,23}} },
+   { 0x036A,  8, 25, {{5,7},{4,6},{2,12},{3,13},{15,17},{9,18},{8,10},{21,23}} },
+   { 0x036B,  7, 23, {{5,7},{4,6},{2,12},{3,13},{9,15},{17,18},{11,21}} },
+   { 0x036C,  7, 23, {{2,6},{9,11},{6,8},{13,15},{5,16},{4,12},{19,21}} },
+   { 0x036D,  9, 27, {{2,6},{9,11},{2,9},{6,14},{7,15},{17,19},{5,21},{4,12},{23,25}} },
+   { 0x036E,  8, 25, {{2,6},{9,11},{6,8},{3,9},{15,17},{5,18},{4,12},{21,23}} },
+   { 0x036F,  7, 23, {{2,6},{9,11},{2,9},{6,15},{5,17},{4,12},{19,21}} },
+   { 0x037C,  7, 23, {{2,6},{4,10},{9,13},{5,7},{15,16},{14,17},{19,21}} },
+   { 0x037D,  8, 25, {{5,7},{4,7},{5,6},{2,13},{15,16},{9,19},{8,10},{21,23}} },
+   { 0x037E,  8, 25, {{5,7},{2,5},{2,6},{11,15},{13,17},{9,19},{8,10},{21,23}} },
+   { 0x03C0,  5, 18, {{5,6},{5,8},{6,9},{13,15},{11,17}} },
+   { 0x03C1,  6, 21, {{6,9},{2,9},{7,13},{5,14},{4,10},{17,19}} },
+   { 0x03C3,  4, 16, {{4,7},{4,9},{6,13},{11,15}} },
+   { 0x03C5,  6, 20, {{5,6},{2,9},{4,8},{7,12},{15,17},{11,18}} },
+   { 0x03C6,  7, 23, {{2,7},{9,11},{3,9},{7,15},{5,16},{4,12},{19,21}} },
+   { 0x03C7,  5, 19, {{7,5},{7,2},{4,9},{13,14},{11,17}} },
+   { 0x03CF,  3, 14, {{4,8},{5,6},{11,13}} },
+   { 0x03D4,  8, 25, {{5,7},{2,5},{3,4},{6,13},{15,17},{9,19},{8,10},{21,23}} },
+   { 0x03D5,  6, 21, {{5,7},{4,6},{2,13},{9,15},{8,10},{17,19}} },
+   { 0x03D6,  7, 23, {{4,6},{2,11},{9,13},{5,7},{15,16},{14,17},{19,21}} },
+   { 0x03D7,  5, 19, {{4,6},{5,7},{2,11},{9,15},{13,17}} },
+   { 0x03D8,  7, 23, {{5,7},{3,6},{2,4},{13,15},{9,17},{8,10},{19,21}} },
+   { 0x03D9,  7, 22, {{6,8},{4,7},{2,9},{4,14},{13,15},{17,19},{11,21}} },
+   { 0x03DB,  6, 21, {{5,7},{2,5},{3,7},{9,13},{15,16},{11,19}} },
+   { 0x03DC,  6, 21, {{5,7},{3,6},{5,13},{9,15},{8,10},{17,19}} },
+   { 0x03DD,  5, 19, {{5,8},{5,2},{9,13},{7,10},{15,17}} },
+   { 0x03DE,  6, 21, {{2,5},{9,11},{5,7},{13,14},{12,15},{17,19}} },
+   { 0x03FC,  4, 17, {{5,7},{8,10},{9,11},{13,15}} },
+   { 0x0660,  7, 22, {{3,5},{6,8},{7,9},{2,4},{13,15},{17,18},{11,20}} },
+   { 0x0661,  9, 26, {{6,8},{7,9},{5,13},{4,12},{15,17},{3,18},{2,14},{21,23},{11,25}} },
+   { 0x0662,  7, 22, {{2,4},{7,9},{6,8},{4,13},{3,17},{15,19},{11,20}} },
+   { 0x0663,  7, 22, {{6,8},{7,9},{3,13},{4,14},{5,15},{17,19},{11,21}} },
+   { 0x0666,  5, 18, {{2,4},{3,5},{6,8},{11,13},{15,16}} },
+   { 0x0667,  7, 22, {{2,4},{7,9},{6,8},{3,5},{13,16},{15,19},{11,20}} },
+   { 0x0669,  9, 27, {{7,9},{2,4},{3,5},{6,8},{13,15},{17,18},{11,20},{10,21},{23,25}} },
+   { 0x066B,  9, 26, {{6,8},{7,9},{4,13},{5,12},{15,17},{3,18},{2,14},{21,23},{11,24}} },
+   { 0x066F,  7, 22, {{6,8},{3,4},{2,5},{7,9},{13,15},{17,18},{11,21}} },
+   { 0x0672,  7, 22, {{2,4},{6,8},{4,8},{3,7},{15,16},{13,19},{11,20}} },
+   { 0x0673,  7, 22, {{7,9},{3,11},{4,13},{3,5},{7,17},{8,19},{15,21}} },
+   { 0x0676,  6, 20, {{2,4},{3,7},{6,8},{5,12},{15,17},{11,18}} },
+   { 0x0678,  9, 27, {{7,9},{3,5},{2,4},{7,13},{8,17},{15,19},{11,20},{10,21},{23,25}} },
+   { 0x0679, 10, 29, {{2,4},{9,11},{2,5},{2,8},{4,17},{15,19},{7,21},{13,22},{12,23},{25,27}} },
+   { 0x067A,  9, 27, {{2,4},{9,11},{4,8},{2,14},{3,15},{17,19},{7,20},{6,12},{23,25}} },
+   { 0x067B,  9, 27, {{2,8},{2,4},{9,13},{7,10},{15,17},{4,7},{18,20},{19,21},{23,25}} },
+   { 0x067E,  8, 24, {{6,8},{5,7},{7,9},{4,15},{2,16},{3,12},{19,21},{11,22}} },
+   { 0x0690, 10, 29, {{5,7},{4,6},{8,11},{13,15},{2,8},{3,6},{19,21},{17,22},{16,23},{25,27}} },
+   { 0x0691, 10, 29, {{2,4},{6,10},{8,11},{13,15},{3,5},{6,8},{19,21},{17,22},{16,23},{25,27}} },
+   { 0x0693,  8, 25, {{3,8},{2,6},{11,13},{6,8},{4,17},{15,18},{14,19},{21,23}} },
+   { 0x0696,  8, 25, {{2,5},{3,4},{9,11},{13,14},{11,13},{7,19},{6,16},{21,23}} },
+   { 0x0697, 10, 29, {{4,7},{4,9},{6,13},{11,15},{5,8},{4,6},{19,21},{3,22},{2,16},{25,27}} },
+   { 0x069F,  9, 27, {{4,8},{5,6},{11,13},{5,8},{4,6},{17,19},{3,20},{2,14},{23,25}} },
+   { 0x06B0,  9, 27, {{3,4},{9,11},{3,5},{2,4},{8,15},{17,18},{7,20},{6,12},{23,25}} },
+   { 0x06B1,  9, 27, {{3,5},{2,4},{7,11},{13,14},{2,6},{11,19},{9,21},{8,16},{23,25}} },
+   { 0x06B2,  8, 24, {{6,8},{2,5},{3,4},{8,14},{6,15},{17,19},{13,20},{11,23}} },
+   { 0x06B3,  8, 25, {{2,7},{8,11},{3,9},{6,15},{4,17},{12,18},{13,19},{21,23}} },
+   { 0x06B4,  8, 25, {{2,5},{3,4},{7,11},{8,15},{13,17},{7,19},{6,18},{21,23}} },
+   { 0x06B5,  8, 25, {{2,7},{3,4},{4,7},{9,13},{15,17},{11,19},{10,18},{21,23}} },
+   { 0x06B6,  7, 23, {{3,4},{9,11},{2,5},{11,15},{7,17},{6,12},{19,21}} },
+   { 0x06B7,  8, 25, {{2,7},{2,9},{6,13},{11,15},{8,11},{5,19},{4,16},{21,23}} },
+   { 0x06B9,  9, 27, {{5,7},{6,8},{4,13},{3,14},{2,10},{17,19},{8,21},{9,20},{23,25}} },
+   { 0x06BD,  9, 27, {{3,4},{9,11},{3,5},{2,4},{7,15},{17,18},{13,20},{12,21},{23,25}} },
+   { 0x06F0,  7, 23, {{3,5},{2,4},{8,11},{13,14},{7,16},{6,9},{19,21}} },
+   { 0x06F1,  7, 23, {{3,5},{2,4},{7,11},{13,14},{9,15},{8,16},{19,21}} },
+   { 0x06F2,  7, 23, {{3,5},{3,8},{4,13},{11,15},{7,16},{6,9},{19,21}} },
+   { 0x06F6,  6, 21, {{2,5},{3,4},{11,13},{7,15},{6,9},{17,19}} },
+   { 0x06F9,  7, 23, {{3,5},{2,4},{7,11},{13,14},{9,17},{8,16},{19,21}} },
+   { 0x0776,  7, 22, {{2,4},{3,7},{7,8},{5,12},{9,17},{15,19},{11,21}} },
+   { 0x0778,  7, 23, {{2,4},{9,11},{8,10},{13,15},{7,16},{6,12},{19,21}} },
+   { 0x0779,  9, 27, {{7,9},{3,5},{10,13},{2,4},{6,8},{17,19},{15,20},{14,21},{23,25}} },
+   { 0x077A,  7, 22, {{6,8},{2,4},{7,9},{2,14},{13,15},{17,19},{11,21}} },
+   { 0x077E,  8, 24, {{6,8},{3,4},{7,9},{2,14},{5,15},{17,19},{13,20},{11,23}} },
+   { 0x07B0,  7, 23, {{3,4},{9,11},{2,4},{8,15},{7,16},{6,12},{19,21}} },
+   { 0x07B1,  8, 25, {{2,4},{7,11},{2,6},{3,5},{15,17},{9,19},{8,12},{21,23}} },
+   { 0x07B4,  7, 23, {{3,4},{9,11},{5,8},{11,15},{7,17},{6,12},{19,21}} },
+   { 0x07B5,  7, 23, {{3,4},{9,11},{5,8},{2,15},{7,17},{6,12},{19,21}} },
+   { 0x07B6,  8, 25, {{3,4},{9,11},{3,9},{5,15},{11,17},{7,19},{6,12},{21,23}} },
+   { 0x07BC,  7, 23, {{3,4},{9,11},{2,4},{7,15},{13,16},{12,17},{19,21}} },
+   { 0x07E0,  7, 23, {{3,5},{9,11},{2,4},{8,15},{7,16},{6,12},{19,21}} },
+   { 0x07E1,  8, 25, {{3,5},{9,11},{2,4},{8,15},{11,17},{7,19},{6,12},{21,23}} },
+   { 0x07E2,  7, 22, {{6,8},{3,5},{3,8},{4,7},{13,17},{15,19},{11,21}} },
+   { 0x07E3,  7, 23, {{3,5},{9,11},{3,8},{4,15},{7,17},{6,12},{19,21}} },
+   { 0x07E6,  7, 22, {{6,8},{2,5},{2,7},{5,9},{15,17},{13,19},{11,21}} },
+   { 0x07E9,  7, 23, {{3,5},{9,11},{2,4},{7,15},{13,16},{12,17},{19,21}} },
+   { 0x07F0,  5, 19, {{7,8},{6,9},{2,4},{10,15},{13,17}} },
+   { 0x07F1,  7, 23, {{2,4},{3,5},{8,11},{13,15},{7,17},{6,9},{19,21}} },
+   { 0x07F2,  6, 21, {{3,8},{2,5},{11,13},{7,15},{6,9},{17,19}} },
+   { 0x07F8,  5, 19, {{2,4},{7,11},{8,12},{9,13},{15,17}} },
+   { 0x0FF0,  3, 15, {{6,9},{7,8},{11,13}} },
+   { 0x1668,  9, 27, {{3,9},{5,7},{11,13},{2,8},{4,6},{17,19},{14,20},{15,21},{23,25}} },
+   { 0x1669, 11, 31, {{7,9},{6,8},{5,13},{4,12},{15,17},{3,18},{2,14},{21,23},{11,25},{10,24},{27,29}} },
+   { 0x166A, 10, 29, {{5,7},{4,6},{8,11},{13,15},{4,8},{6,18},{3,21},{17,22},{16,23},{25,27}} },
+   { 0x166B, 11, 31, {{3,9},{5,7},{9,12},{11,13},{15,17},{2,8},{4,6},{21,23},{19,24},{18,25},{27,29}} },
+   { 0x166E,  9, 27, {{7,9},{6,8},{2,4},{11,14},{13,17},{3,5},{19,20},{18,21},{23,25}} },
+   { 0x167E,  9, 26, {{4,6},{3,9},{10,13},{2,8},{5,7},{2,18},{17,19},{21,23},{15,25}} },
+   { 0x1681, 11, 31, {{2,9},{5,7},{11,13},{2,8},{3,9},{4,6},{17,19},{21,22},{14,24},{15,25},{27,29}} },
+   { 0x1683, 10, 29, {{5,7},{2,8},{4,6},{3,14},{9,15},{17,19},{13,20},{11,22},{10,23},{25,27}} },
+   { 0x1686,  9, 27, {{2,4},{6,8},{11,13},{3,5},{6,9},{17,19},{15,21},{14,20},{23,25}} },
+   { 0x1687,  9, 27, {{5,8},{6,8},{4,13},{2,14},{3,10},{17,19},{6,21},{7,20},{23,25}} },
+   { 0x1689, 10, 29, {{2,4},{6,8},{3,5},{6,14},{13,15},{17,19},{11,21},{8,22},{9,23},{25,27}} },
+   { 0x168B, 10, 29, {{5,7},{4,9},{4,6},{8,15},{3,16},{2,12},{19,21},{11,23},{10,22},{25,27}} },
+   { 0x168E, 10, 29, {{4,8},{5,6},{11,13},{5,7},{5,8},{6,19},{17,21},{3,22},{2,14},{25,27}} },
+   { 0x1696,  8, 25, {{2,4},{3,5},{6,8},{10,15},{13,17},{6,19},{7,18},{21,23}} },
+   { 0x1697, 10, 29, {{7,9},{5,11},{6,8},{4,15},{2,16},{3,12},{19,21},{6,23},{7,22},{25,27}} },
+   { 0x1698, 10, 29, {{2,9},{5,7},{11,13},{7,8},{2,8},{4,17},{19,21},{14,22},{15,23},{25,27}} },
+   { 0x1699,  9, 27, {{7,8},{2,4},{8,12},{11,13},{15,17},{3,5},{19,20},{18,21},{23,25}} },
+   { 0x169A,  8, 25, {{5,6},{3,6},{4,8},{13,14},{11,17},{3,19},{2,18},{21,23}} },
+   { 0x169B, 10, 29, {{4,8},{5,6},{11,13},{7,8},{4,16},{5,17},{19,21},{3,23},{2,14},{25,27}} },
+   { 0x169E,  8, 25, {{4,8},{5,6},{11,13},{4,7},{13,17},{3,19},{2,14},{21,23}} },
+   { 0x16A9,  9, 27, {{5,7},{3,8},{2,9},{4,6},{12,17},{15,19},{11,21},{10,20},{23,25}} },
+   { 0x16AC,  9, 27, {{5,7},{2,8},{5,8},{3,6},{15,16},{13,19},{11,20},{10,21},{23,25}} },
+   { 0x16AD,  9, 27, {{2,4},{7,11},{3,9},{3,5},{8,17},{15,19},{13,20},{12,21},{23,25}} },
+   { 0x16BC,  8, 25, {{5,7},{3,4},{2,8},{6,12},{15,17},{11,18},{10,19},{21,23}} },
+   { 0x16E9,  9, 27, {{5,7},{4,6},{3,13},{8,14},{9,15},{17,19},{11,21},{10,20},{23,25}} },
+   { 0x177E, 10, 28, {{6,8},{3,5},{10,13},{3,4},{7,9},{2,18},{5,19},{21,23},{17,24},{15,27}} },
+   { 0x178E,  9, 27, {{4,8},{5,6},{11,13},{5,8},{4,7},{17,19},{3,21},{2,14},{23,25}} },
+   { 0x1796, 10, 29, {{7,8},{5,11},{6,8},{4,15},{2,16},{3,12},{19,21},{6,23},{7,22},{25,27}} },
+   { 0x1798,  8, 25, {{3,6},{5,10},{7,8},{2,4},{8,16},{15,17},{19,21},{13,23}} },
+   { 0x179A,  8, 25, {{4,8},{5,6},{11,13},{7,8},{13,17},{3,19},{2,14},{21,23}} },
+   { 0x17AC,  8, 25, {{3,4},{8,11},{4,7},{2,6},{15,17},{12,18},{13,19},{21,23}} },
+   { 0x17E8,  7, 23, {{3,5},{2,4},{6,11},{13,15},{9,17},{8,16},{19,21}} },
+   { 0x18E7,  8, 25, {{3,4},{3,6},{4,7},{13,15},{11,17},{9,19},{8,18},{21,23}} },
+   { 0x19E1,  9, 27, {{6,9},{2,7},{2,5},{8,12},{4,17},{15,19},{11,20},{10,21},{23,25}} },
+   { 0x19E3,  9, 27, {{3,7},{9,11},{2,5},{2,7},{4,17},{15,19},{13,20},{12,21},{23,25}} },
+   { 0x19E6,  7, 23, {{2,5},{2,7},{4,13},{11,15},{9,17},{8,16},{19,21}} },
+   { 0x1BD8,  9, 27, {{6,8},{5,9},{11,13},{6,9},{5,8},{17,19},{3,21},{2,14},{23,25}} },
+   { 0x1BE4,  6, 21, {{2,6},{3,4},{11,13},{9,15},{8,14},{17,19}} },
+   { 0x1EE1,  7, 23, {{3,5},{8,10},{9,11},{13,15},{7,16},{6,17},{19,21}} },
+   { 0x3CC3,  6, 21, {{6,9},{7,8},{11,13},{5,14},{4,15},{17,19}} },
+   { 0x6996,  9, 27, {{6,9},{7,8},{11,13},{5,15},{4,14},{17,19},{3,21},{2,20},{23,25}} }
+};
+
+static_assert(npnLibSorted(_npnLib, NPN_CLASS_NUM),
+              "NPN class library must be sorted by truth table");
+
+/**************************************/
+/*   Static varaibles and functions   */
+/**************************************/
+// Canonical form of each function, filled in on demand:
+// bit 0-15: canonical truth table; bit 16-25: transform + 1 (0: not yet).
+// An entry is one word, so threads that compute it together store the
+// same value and a relaxed load sees either 0 or all of it.
+static atomic<unsigned> _npnCache[1 << 16];
+
+/*****************************************/
+/*   NPN canonicalization                */
+/*****************************************/
+const CirNpnClass*
+npnCanonicalize(unsigned f, unsigned& perm, unsigned& phase, bool& outInv)
+{
+   assert(f < (1u << 16));
+   unsigned e = _npnCache[f].load(memory_order_relaxed);
+   if (e == 0) {
+      unsigned best = 1u << 16, bestT = 0;
+      for (unsigned t = 0; t < NPN_TRANSFORM_NUM; ++t) {
+         unsigned g = npnTransform(f, t / 32, (t / 2) % 16, t % 2);
+         if (g < best) { best = g; bestT = t; }
+      }
+      e = best | ((bestT + 1) << 16);
+      _npnCache[f].store(e, memory_order_relaxed);
+   }
+   const unsigned t = (e >> 16) - 1;
+   perm = t / 32; phase = (t / 2) % 16; outInv = t % 2;
+
+   // binary search the class
+   unsigned lo = 0, hi = NPN_CLASS_NUM;
+   const unsigned canon = e & 0xFFFF;
+   while (lo < hi) {
+      unsigned mid = (lo + hi) / 2;
+      if (_npnLib[mid]._truth < canon) lo = mid + 1;
+      else hi = mid;
+   }
+   assert(lo < NPN_CLASS_NUM && _npnLib[lo]._truth == canon);
+   return &_npnLib[lo];
+}
@@ -0,0 +1,73 @@
+/****************************************************************************
+  FileName     [ cirNpn.h ]
+  PackageName  [ cir ]
+  Synopsis     [ Define NPN classification of 4-input functions ]
+  Author       [ Chung-Yang (Ric) Huang ]
+  Copyright    [ Copyleft(c) 2008-present LaDs(III), GIEE, NTU, Taiwan ]
+****************************************************************************/
+
+#ifndef CIR_NPN_H
+#define CIR_NPN_H
+
+#define NPN_CLASS_NUM      222
+#define NPN_TRANSFORM_NUM  768   // 24 permutations x 16 phases x 2
+#define NPN_MAX_NODE       11
+
+//------------------------------------------------------------------------
+//   class CirNpnClass
+//------------------------------------------------------------------------
+// The precomputed AIG of an NPN class.  A literal is 2 * var + inverted,
+// where var 0 is constant 0, var 1-4 are the inputs and var 5+k is node k.
+struct CirNpnClass
+{
+   unsigned short _truth;      // canonical truth table
+   unsigned char  _nNodes;
+   unsigned char  _out;        // output literal
+   unsigned char  _node[NPN_MAX_NODE][2];
+};
+
+//------------------------------------------------------------------------
+//   NPN transforms (evaluated at compile time where used as constants)
+//------------------------------------------------------------------------
+constexpr unsigned char _npnPerm[24][4] = {
+   {0,1,2,3}, {0,1,3,2}, {0,2,1,3}, {0,2,3,1}, {0,3,1,2}, {0,3,2,1},
+   {1,0,2,3}, {1,0,3,2}, {1,2,0,3}, {1,2,3,0}, {1,3,0,2}, {1,3,2,0},
+   {2,0,1,3}, {2,0,3,1}, {2,1,0,3}, {2,1,3,0}, {2,3,0,1}, {2,3,1,0},
+   {3,0,1,2}, {3,0,2,1}, {3,1,0,2}, {3,1,2,0}, {3,2,0,1}, {3,2,1,0}
+};
+
+// The minterm of f selected by minterm y of the transformed function
+constexpr unsigned
+npnMinterm(unsigned p, unsigned ph, unsigned y, unsigned j = 0)
+{
+   return j == 4 ? 0 :
+      ((((y ^ ph) >> j) & 1u) << _npnPerm[p][j]) | npnMinterm(p, ph, y, j + 1);
+}
+
+// g(y) = f(x) ^ o, where x[_npnPerm[p][j]] = y[j] ^ ph[j]
+constexpr unsigned
+npnTransform(unsigned f, unsigned p, unsigned ph, unsigned o, unsigned y = 0)
+{
+   return y == 16 ? 0 :
+      ((((f >> npnMinterm(p, ph, y)) ^ o) & 1u) << y) |
+      npnTransform(f, p, ph, o, y + 1);
+}
+
+constexpr bool
+npnLibSorted(const CirNpnClass* lib, unsigned n, unsigned i = 1)
+{
+   return i >= n ||
+      (lib[i - 1]._truth < lib[i]._truth && npnLibSorted(lib, n, i + 1));
+}
+
+static_assert(npnTransform(0xAAAA, 0, 0, 0) == 0xAAAA, "identity transform");
+static_assert(npnTransform(0xAAAA, 6, 0, 0) == 0xCCCC, "swap input 0 and 1");
+static_assert(npnTransform(0x8000, 0, 0xF, 1) == 0xFFFE, "NPN of AND4");
+
+// Return the class of the 4-input function f, and the transform that maps
+// f to it: class input j is f input _npnPerm[perm][j], complemented if
+// bit j of phase is set, and f = class output ^ outInv.
+extern const CirNpnClass* npnCanonicalize(unsigned f, unsigned& perm,
+                                          unsigned& phase, bool& outInv);
+
+#endif // CIR_NPN_H
@@ -0,0 +1,235 @@
+/****************************************************************************
+  FileName     [ cirOpt.cpp ]
+  PackageName  [ cir ]
+  Synopsis     [ Define cir netlist editing functions ]
+  Author       [ Chung-Yang (Ric) Huang ]
+  Copyright    [ Copyleft(c) 2008-present LaDs(III), GIEE, NTU, Taiwan ]
+****************************************************************************/
+
+#include <cassert>
+#include "cirMgr.h"
+#include "cirGate.h"
+#include "util.h"
+
+using namespace std;
+
+/**************************************************************/
+/*   class CirMgr member functions for netlist editing        */
+/**************************************************************/
+unsigned
+CirMgr::newGateId()
+{
+  // never reuse an id, even that of a deleted gate
+  if (_nextId < getGateIdEnd()) _nextId = getGateIdEnd();
+  return _nextId++;
+}
+
+size_t
+CirMgr::strashKey(CirGateV a, CirGateV b)
+{
+  size_t la = a.gate()->_id * 2 + a.isInv();
+  size_t lb = b.gate()->_id * 2 + b.isInv();
+  if (la > lb) swap(la, lb);
+  return (la << 32) | lb;
+}
+
+// Hash all the AIG gates by their fanins; a structurally equivalent gate
+// found later is left as is and the first one is kept in the table.
+// Once built, the table is kept up to date by the editing functions.
+void
+CirMgr::buildStrash()
+{
+  if (_strashBuilt) return;
+  if (!_snapshots.empty()) _snapshots.back()->_strashLost = true;
+  _strash.clear();
+  _strash.reserve(_aig.size() * 2);
+  for (size_t i = 0; i < _aig.size(); i++) {
+    if (!isAlive(_aig[i])) continue;
+    _strash.insert(make_pair(strashKey(_aig[i]->getFanin(0),
+                                       _aig[i]->getFanin(1)), _aig[i]));
+  }
+  _strashBuilt = true;
+}
+
+void
+CirMgr::unhash(CirGate* g)
+{
+  if (!_strashBuilt || g->_type != AIG_GATE) return;
+  unordered_map<size_t, CirGate*>::iterator it =
+    _strash.find(strashKey(g->getFanin(0), g->getFanin(1)));
+  if (it != _strash.end() && it->second == g) {
+    logStrash(it->first, g);
+    _strash.erase(it);
+  }
+}
+
+// Constant propagation and x&x, x&!x
+bool
+CirMgr::trivialAnd(CirGateV a, CirGateV b, CirGateV& r) const
+{
+  if (a.gate()->_type == CONST_GATE) { r = a.isInv() ? b : a; return true; }
+  if (b.gate()->_type == CONST_GATE) { r = b.isInv() ? a : b; return true; }
+  if (a == b) { r = a; return true; }
+  if (a == !b) { r = getConst(); return true; }
+  return false;
+}
+
+// Return the existing literal of a & b, or a null literal if none
+CirGateV
+CirMgr::findAnd(CirGateV a, CirGateV b) const
+{
+  assert(_strashBuilt);
+  CirGateV r;
+  if (trivialAnd(a, b, r)) return r;
+  unordered_map<size_t, CirGate*>::const_iterator it =
+    _strash.find(strashKey(a, b));
+  return (it == _strash.end()) ? CirGateV() : CirGateV(it->second);
+}
+
+CirGateV
+CirMgr::strashAnd(CirGateV a, CirGateV b)
+{
+  if (!_strashBuilt) buildStrash();
+  CirGateV r = findAnd(a, b);
+  if (r.gate()) return r;
+
+  if (a.gate()->_id > b.gate()->_id) swap(a, b);
+  netChanged();
+  touch(a.gate()); touch(b.gate());
+  CirGate* g = new CirAigGate(newGateId(), 0);
+  if (!_snapshots.empty()) {
+    g->_cowStamp = _snapshots.back()->_serial;
+    _snapshots.back()->_created.push_back(g);
+  }
+  g->setFanin(a.gate()); g->setBool(a.isInv()); a.gate()->setFanout(g);
+  g->setFanin(b.gate()); g->setBool(b.isInv()); b.gate()->setFanout(g);
+  _map[g->_id] = g;
+  _aig.push_back(g);
+  logStrash(strashKey(a, b), 0);
+  _strash[strashKey(a, b)] = g;
+  timingDirty(g);
+  return CirGateV(g);
+}
+
+// Move all fanouts of g to v.  A fanout that becomes trivial or
+// structurally equivalent to another gate is merged in turn; g and every
+// gate merged away are then removed together with their unused fanin cones.
+void
+CirMgr::replaceGate(CirGate* g, CirGateV v)
+{
+  netChanged();
+  vector<pair<CirGate*, CirGateV> > work(1, make_pair(g, v));
+  GateList replaced;
+  while (!work.empty()) {
+    CirGate* old = work.back().first;
+    CirGateV to = work.back().second;
+    work.pop_back();
+    if (!isAlive(old) || to.gate() == old) continue;
+    replaced.push_back(old);
+    touch(old);
+    touch(to.gate());
+
+    GateList fanouts;
+    fanouts.swap(old->_fanout);
+    for (size_t i = 0; i < fanouts.size(); i++) {
+      CirGate* fo = fanouts[i];
+      bool found = false;
+      for (size_t j = 0; j < fo->_fanin.size(); j++)
+        if (fo->_fanin[j] == old) found = true;
+      if (!found) continue;   // same fanout listed twice
+
+      touch(fo);
+      unhash(fo);
+      for (size_t j = 0; j < fo->_fanin.size(); j++) {
+        if (fo->_fanin[j] != old) continue;
+        fo->_fanin[j] = to.gate();
+        fo->_invert[j] = fo->_invert[j] ^ to.isInv();
+        to.gate()->setFanout(fo);
+      }
+      if (fo->_type != AIG_GATE) continue;
+
+      CirGateV r;
+      if (trivialAnd(fo->getFanin(0), fo->getFanin(1), r)) {
+        work.push_back(make_pair(fo, r));
+        continue;
+      }
+      if (!_strashBuilt) continue;
+      size_t key = strashKey(fo->getFanin(0), fo->getFanin(1));
+      unordered_map<size_t, CirGate*>::iterator it = _strash.find(key);
+      if (it == _strash.end()) {
+        logStrash(key, 0);
+        _strash[key] = fo;
+      }
+      else if (it->second != fo) work.push_back(make_pair(fo, CirGateV(it->second)));
+    }
+  }
+  for (size_t i = 0; i < replaced.size(); i++)
+    deleteUnused(replaced[i]);
+}
+
+// Reconnect fanin i of g to v.  The old fanin is left as is, even if it
+// has no fanout any more.
+void
+CirMgr::setFanin(CirGate* g, size_t i, CirGateV v)
+{
+  netChanged();
+  CirGate* old = g->_fanin[i];
+  touch(g); touch(old); touch(v.gate());
+  unhash(g);
+  g->_fanin[i] = v.gate();
+  g->_invert[i] = g->_invert[i] ^ v.isInv();
+  old->removeFanout(g);
+  v.gate()->setFanout(g);
+  if (_strashBuilt && g->_type == AIG_GATE) {
+    const size_t key = strashKey(g->getFanin(0), g->getFanin(1));
+    if (_strash.insert(make_pair(key, g)).second) logStrash(key, 0);
+  }
+}
+
+// Remove g and its fanin cone as long as the gates have no fanout.
+// The gates are only freed in cleanGarbage().
+void
+CirMgr::deleteUnused(CirGate* g)
+{
+  netChanged();
+  GateList stack(1, g);
+  while (!stack.empty()) {
+    g = stack.back(); stack.pop_back();
+    if (g->_type != AIG_GATE || !g->_fanout.empty() || !isAlive(g))
+      continue;
+    unhash(g);
+    for (size_t j = 0; j < g->_fanin.size(); j++) {
+      touch(g->_fanin[j]);
+      g->_fanin[j]->removeFanout(g);
+      stack.push_back(g->_fanin[j]);
+    }
+    _map.erase(g->_id);
+    _garbage.push_back(g);
+  }
+}
+
+void
+CirMgr::cleanGarbage()
+{
+  if (_garbage.empty()) return;
+  if (!_snapshots.empty() && !_snapshots.back()->_aigSaved) {
+    CirSnapshot* s = _snapshots.back();
+    s->_aig.assign(_aig.begin(), _aig.begin() + s->_nAig);
+    s->_aigSaved = true;
+  }
+  size_t des = 0;
+  for (size_t i = 0, n = _aig.size(); i < n; i++) {
+    if (!isAlive(_aig[i])) continue;
+    if (i != des) _aig[des] = _aig[i];
+    ++des;
+  }
+  _aig.resize(des);
+  // the removed gates are kept for restoring the latest snapshot
+  if (!_snapshots.empty()) {
+    GateList& removed = _snapshots.back()->_removed;
+    removed.insert(removed.end(), _garbage.begin(), _garbage.end());
+  }
+  else for (size_t i = 0; i < _garbage.size(); i++)
+    delete _garbage[i];
+  clearList(_garbage);
+}
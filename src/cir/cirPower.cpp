@@ -0,0 +1,155 @@
+/****************************************************************************
+  FileName     [ cirPower.cpp ]
+  PackageName  [ cir ]
+  Synopsis     [ Define switching activity estimation by simulation ]
+  Author       [ Chung-Yang (Ric) Huang ]
+  Copyright    [ Copyleft(c) 2008-present LaDs(III), GIEE, NTU, Taiwan ]
+****************************************************************************/
+
+#include <iostream>
+#include <iomanip>
+#include <algorithm>
+#include <stdint.h>
+#include "cirMgr.h"
+#include "cirGate.h"
+#include "util.h"
+
+using namespace std;
+
+/**************************************/
+/*   Static varaibles and functions   */
+/**************************************/
+// Words of 64 patterns simulated at a time
+#define POWER_WORDS   16
+
+// Without POPCNT (see POPCNT in Makefile.in), the builtin is a library
+// call, so the bits are counted in place instead
+static inline unsigned
+countOnes(uint64_t x)
+{
+#ifdef __POPCNT__
+   return __builtin_popcountll(x);
+#else
+   x = x - ((x >> 1) & 0x5555555555555555ULL);
+   x = (x & 0x3333333333333333ULL) + ((x >> 2) & 0x3333333333333333ULL);
+   x = (x + (x >> 4)) & 0x0f0f0f0f0f0f0f0fULL;
+   return unsigned((x * 0x0101010101010101ULL) >> 56);
+#endif
+}
+
+static inline uint64_t
+randomWord(RandomNumGen& gen)
+{
+   uint64_t w = 0;
+   for (unsigned b = 0; b < 64; b += 16)
+      w |= uint64_t(gen(1 << 16)) << b;
+   return w;
+}
+
+/**************************************************************/
+/*   class CirMgr member functions for power estimation       */
+/**************************************************************/
+// Bit-parallel simulation of nPatterns random patterns (rounded up to a
+// multiple of 64) in DFS order; pattern k is bit k % 64 of word k / 64.
+// The signal probability of a gate is the fraction of 1s in its signature
+// and its toggle rate the fraction of consecutive patterns it changes on.
+// The switched capacitance proxy weights the toggle rate by the fanouts
+// in the DFS list; the fanouts out of the POs' cones do not switch a load.
+// The nTop gates of the largest proxy are listed, all of them if nTop is 0.
+void
+CirMgr::reportPower(size_t nPatterns, unsigned seed, size_t nTop) const
+{
+  const GateList& dfsTl = getDfsList();
+  const size_t n = dfsTl.size();
+  const size_t nWords = max<size_t>(1, (nPatterns + 63) / 64);
+  vector<unsigned> pos(getGateIdEnd(), 0);
+  vector<char> inDfs(getGateIdEnd(), 0);
+  for (size_t i = 0; i < n; i++) {
+    pos[dfsTl[i]->_id] = i;
+    inDfs[dfsTl[i]->_id] = 1;
+  }
+  vector<unsigned> fanouts(n, 0);
+  for (size_t i = 0; i < n; i++) {
+    const GateList& fo = dfsTl[i]->_fanout;
+    for (size_t j = 0; j < fo.size(); j++) fanouts[i] += inDfs[fo[j]->_id];
+  }
+
+  vector<uint64_t> val(n * POWER_WORDS);
+  vector<uint64_t> ones(n, 0), toggles(n, 0);
+  RandomNumGen gen(seed);
+  for (size_t w0 = 0; w0 < nWords; w0 += POWER_WORDS) {
+    const size_t nw = min<size_t>(POWER_WORDS, nWords - w0);
+    for (size_t i = 0; i < n; i++) {
+      const CirGate* g = dfsTl[i];
+      uint64_t* v = &val[i * POWER_WORDS];
+      // the last pattern of the previous words, in bit 63
+      const uint64_t prev = v[POWER_WORDS - 1];
+      if (g->_type == PI_GATE)
+        for (size_t w = 0; w < nw; w++) v[w] = randomWord(gen);
+      else if (g->_type == AIG_GATE) {
+        const uint64_t* a = &val[pos[g->_fanin[0]->_id] * POWER_WORDS];
+        const uint64_t* b = &val[pos[g->_fanin[1]->_id] * POWER_WORDS];
+        const uint64_t ia = g->_invert[0] ? ~uint64_t(0) : 0;
+        const uint64_t ib = g->_invert[1] ? ~uint64_t(0) : 0;
+        for (size_t w = 0; w < nw; w++) v[w] = (a[w] ^ ia) & (b[w] ^ ib);
+      }
+      else if (g->_type == PO_GATE) {
+        const uint64_t* a = &val[pos[g->_fanin[0]->_id] * POWER_WORDS];
+        const uint64_t ia = g->_invert[0] ? ~uint64_t(0) : 0;
+        for (size_t w = 0; w < nw; w++) v[w] = a[w] ^ ia;
+      }
+      else
+        for (size_t w = 0; w < nw; w++) v[w] = 0;
+
+      // bit k of v ^ (v << 1 | carry) compares patterns k and k - 1
+      uint64_t carry = prev >> 63;
+      for (size_t w = 0; w < nw; w++) {
+        uint64_t x = v[w] ^ ((v[w] << 1) | carry);
+        if (w0 + w == 0) x &= ~uint64_t(1);
+        ones[i] += countOnes(v[w]);
+        toggles[i] += countOnes(x);
+        carry = v[w] >> 63;
+      }
+      if (nw < POWER_WORDS) v[POWER_WORDS - 1] = v[nw - 1];
+    }
+  }
+
+  const double nPat = nWords * 64.0;
+  double sumProb = 0, sumToggle = 0, switched = 0;
+  size_t nGates = 0;
+  vector<pair<double, unsigned> > load;   // (switched capacitance, index)
+  for (size_t i = 0; i < n; i++) {
+    const CirGate* g = dfsTl[i];
+    if (g->_type == CONST_GATE) continue;
+    const double toggle = toggles[i] / (nPat - 1);
+    ++nGates;
+    sumProb += ones[i] / nPat;
+    sumToggle += toggle;
+    switched += toggle * fanouts[i];
+    load.push_back(make_pair(toggle * fanouts[i], unsigned(i)));
+  }
+  if (!nGates) nGates = 1;
+  cout << "Patterns            " << size_t(nPat) << endl
+       << "Avg signal prob     " << sumProb / nGates << endl
+       << "Avg toggle rate     " << sumToggle / nGates << endl
+       << "Switched cap proxy  " << switched
+       << "  (toggle rate x fanouts, per pattern)" << endl;
+
+  if (!nTop || nTop > load.size()) nTop = load.size();
+  partial_sort(load.begin(), load.begin() + nTop, load.end(),
+               greater<pair<double, unsigned> >());
+  cout << endl << setw(10) << right << "Gate" << "  " << setw(6) << left
+       << "Type" << right << setw(8) << "Fanout" << setw(10) << "Prob"
+       << setw(10) << "Toggle" << setw(11) << "Switched" << endl;
+  cout << fixed << setprecision(4);
+  for (size_t k = 0; k < nTop; k++) {
+    const unsigned i = load[k].second;
+    const CirGate* g = dfsTl[i];
+    cout << setw(10) << g->_id << "  " << setw(6) << left << g->getTypeStr()
+         << right << setw(8) << fanouts[i] << setw(10)
+         << ones[i] / nPat << setw(10) << toggles[i] / (nPat - 1)
+         << setw(11) << load[k].first << endl;
+  }
+  cout.unsetf(ios::floatfield);
+  cout << setprecision(6);
+}
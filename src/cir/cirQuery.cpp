@@ -0,0 +1,116 @@
+/****************************************************************************
+  FileName     [ cirQuery.cpp ]
+  PackageName  [ cir ]
+  Synopsis     [ Define read-only circuit queries ]
+  Author       [ Chung-Yang (Ric) Huang ]
+  Copyright    [ Copyleft(c) 2008-present LaDs(III), GIEE, NTU, Taiwan ]
+****************************************************************************/
+
+#include <cassert>
+#include "cirMgr.h"
+#include "cirGate.h"
+#include "util.h"
+
+using namespace std;
+
+/**************************************************************/
+/*   class CirMgr member functions for circuit queries        */
+/**************************************************************/
+bool
+CirMgr::queryGate(unsigned gid, CirGateInfo& info) const
+{
+  const CirGate* g = getGate(gid);
+  info._id = gid;
+  if (!g) {
+    info._type = TOT_GATE;
+    info._lineNo = info._nFanin = info._nFanout = 0;
+    info._name.clear();
+    return false;
+  }
+  info._type = g->_type;
+  info._lineNo = g->_lineNo;
+  info._name = g->_name;
+  info._nFanin = g->_fanin.size();
+  info._nFanout = getFanoutCsr().size(gid);
+  return true;
+}
+
+// Return the number of gates found
+size_t
+CirMgr::queryGates(const IdList& gids, vector<CirGateInfo>& infos) const
+{
+  infos.resize(gids.size());
+  size_t n = 0;
+  for (size_t i = 0; i < gids.size(); i++)
+    if (queryGate(gids[i], infos[i])) ++n;
+  return n;
+}
+
+// The gates up to level edges before gid, depth first.  A gate reached
+// again is listed at each place, but its cone only at the first one.
+bool
+CirMgr::queryFanin(unsigned gid, unsigned level, vector<CirConeEntry>& cone,
+                   CirTravContext& ctx) const
+{
+  cone.clear();
+  const CirGate* g = getGate(gid);
+  if (!g) return false;
+  ctx.newTrav();
+  cone.push_back(CirConeEntry(g, 0, false, false));
+  if (level > 0)
+    for (size_t i = 0; i < g->_fanin.size(); i++)
+      coneIn(g->_fanin[i], g->_invert[i], 1, level, cone, ctx);
+  return true;
+}
+
+void
+CirMgr::coneIn(const CirGate* g, bool inv, unsigned depth, unsigned level,
+               vector<CirConeEntry>& cone, CirTravContext& ctx) const
+{
+  if (ctx.isMarked(g)) {
+    cone.push_back(CirConeEntry(g, depth, inv, !g->_fanin.empty()));
+    return;
+  }
+  cone.push_back(CirConeEntry(g, depth, inv, false));
+  ctx.mark(g);
+  if (depth < level)
+    for (size_t i = 0; i < g->_fanin.size(); i++)
+      coneIn(g->_fanin[i], g->_invert[i], depth + 1, level, cone, ctx);
+}
+
+// The same for the gates up to level edges after gid
+bool
+CirMgr::queryFanout(unsigned gid, unsigned level, vector<CirConeEntry>& cone,
+                    CirTravContext& ctx) const
+{
+  cone.clear();
+  const CirGate* g = getGate(gid);
+  if (!g) return false;
+  const CirFanoutCsr& fanouts = getFanoutCsr();
+  ctx.newTrav();
+  cone.push_back(CirConeEntry(g, 0, false, false));
+  if (level > 0)
+    for (size_t i = 0; i < fanouts.size(gid); i++) {
+      CirGateV fo = fanouts.edge(gid, i);
+      coneOut(fo.gate(), fo.isInv(), 1, level, cone, ctx);
+    }
+  return true;
+}
+
+void
+CirMgr::coneOut(const CirGate* g, bool inv, unsigned depth, unsigned level,
+                vector<CirConeEntry>& cone, CirTravContext& ctx) const
+{
+  const CirFanoutCsr& fanouts = getFanoutCsr();
+  if (ctx.isMarked(g)) {
+    cone.push_back(CirConeEntry(g, depth, inv, fanouts.size(g->_id) > 0));
+    return;
+  }
+  cone.push_back(CirConeEntry(g, depth, inv, false));
+  ctx.mark(g);
+  if (depth < level)
+    for (size_t i = 0; i < fanouts.size(g->_id); i++) {
+      CirGateV fo = fanouts.edge(g->_id, i);
+      coneOut(fo.gate(), fo.isInv(), depth + 1, level, cone, ctx);
+    }
+}
@@ -0,0 +1,204 @@
+/****************************************************************************
+  FileName     [ cirRewrite.cpp ]
+  PackageName  [ cir ]
+  Synopsis     [ Define DAG-aware AIG rewriting with 4-input cuts ]
+  Author       [ Chung-Yang (Ric) Huang ]
+  Copyright    [ Copyleft(c) 2008-present LaDs(III), GIEE, NTU, Taiwan ]
+****************************************************************************/
+
+#include <iostream>
+#include <cassert>
+#include "cirMgr.h"
+#include "cirGate.h"
+#include "cirCut.h"
+#include "cirNpn.h"
+#include "util.h"
+
+using namespace std;
+
+/**************************************/
+/*   Static varaibles and functions   */
+/**************************************/
+// Rewrite each gate with the precomputed structure of one of its 4-input
+// cuts when that reduces the number of AIG gates, counting the gates freed
+// from its maximum fanout-free cone (MFFC) against those really added
+// after structural hashing.
+class CirRewriter
+{
+public:
+   CirRewriter(CirMgr* mgr): _mgr(mgr), _cuts(4, 8) {}
+
+   unsigned rewrite();
+
+private:
+   CirMgr*            _mgr;
+   CirCutMgr          _cuts;
+   vector<unsigned>   _deref;     // indexed by gate id
+   GateList           _touched;
+   CirGate*           _leaf[4];
+   unsigned           _nLeaf;
+
+   unsigned& deref(CirGate* g) {
+      if (g->_id >= _deref.size()) _deref.resize(g->_id + 1, 0);
+      return _deref[g->_id];
+   }
+   unsigned refCount(CirGate* g) {
+      return g->_fanout.size() - deref(g);
+   }
+   bool isLeaf(const CirGate* g) const {
+      for (unsigned i = 0; i < _nLeaf; ++i)
+         if (_leaf[i] == g) return true;
+      return false;
+   }
+   unsigned derefMffc(CirGate*);
+   void resetDeref();
+   CirGateV input(unsigned, unsigned, unsigned) const;
+   bool countAdded(CirGate*, const CirNpnClass*, unsigned, unsigned, int&);
+   CirGateV build(const CirNpnClass*, unsigned, unsigned);
+};
+
+// Count the gates only used by g down to the cut leaves
+unsigned
+CirRewriter::derefMffc(CirGate* g)
+{
+   unsigned n = 1;
+   for (size_t j = 0; j < g->_fanin.size(); ++j) {
+      CirGate* f = g->_fanin[j];
+      if (f->_type != AIG_GATE || isLeaf(f)) continue;
+      if (deref(f)++ == 0) _touched.push_back(f);
+      if (refCount(f) == 0) n += derefMffc(f);
+   }
+   return n;
+}
+
+void
+CirRewriter::resetDeref()
+{
+   for (size_t i = 0; i < _touched.size(); ++i)
+      _deref[_touched[i]->_id] = 0;
+   _touched.clear();
+}
+
+// The literal feeding class input j
+CirGateV
+CirRewriter::input(unsigned j, unsigned perm, unsigned phase) const
+{
+   const unsigned k = _npnPerm[perm][j];
+   if (k >= _nLeaf) return _mgr->getConst();   // not in the support
+   return CirGateV(_leaf[k], (phase >> j) & 1);
+}
+
+// Number of gates the structure adds after sharing; call with the MFFC of
+// g dereferenced.  Return false if the structure is g itself.
+bool
+CirRewriter::countAdded(CirGate* g, const CirNpnClass* c, unsigned perm,
+                        unsigned phase, int& added)
+{
+   CirGateV lit[5 + NPN_MAX_NODE];
+   bool isNew[5 + NPN_MAX_NODE];
+   lit[0] = _mgr->getConst(); isNew[0] = false;
+   for (unsigned j = 0; j < 4; ++j) {
+      lit[j + 1] = input(j, perm, phase);
+      isNew[j + 1] = false;
+   }
+   added = 0;
+   for (unsigned k = 0; k < c->_nNodes; ++k) {
+      const unsigned a = c->_node[k][0], b = c->_node[k][1];
+      CirGateV& r = lit[5 + k];
+      bool& rNew = isNew[5 + k];
+      rNew = isNew[a / 2] || isNew[b / 2];
+      if (!rNew) {
+         r = _mgr->findAnd(lit[a / 2] ^ (a & 1), lit[b / 2] ^ (b & 1));
+         if (!r.gate()) rNew = true;
+         // reusing a gate of the MFFC keeps it alive
+         else if (r.gate()->_type == AIG_GATE &&
+                  (r.gate() == g || refCount(r.gate()) == 0)) ++added;
+      }
+      if (rNew) ++added;
+   }
+   const unsigned out = c->_out / 2;
+   return isNew[out] || lit[out].gate() != g;
+}
+
+CirGateV
+CirRewriter::build(const CirNpnClass* c, unsigned perm, unsigned phase)
+{
+   CirGateV lit[5 + NPN_MAX_NODE];
+   lit[0] = _mgr->getConst();
+   for (unsigned j = 0; j < 4; ++j)
+      lit[j + 1] = input(j, perm, phase);
+   for (unsigned k = 0; k < c->_nNodes; ++k) {
+      const unsigned a = c->_node[k][0], b = c->_node[k][1];
+      lit[5 + k] = _mgr->strashAnd(lit[a / 2] ^ (a & 1), lit[b / 2] ^ (b & 1));
+   }
+   return lit[c->_out / 2] ^ (c->_out & 1);
+}
+
+unsigned
+CirRewriter::rewrite()
+{
+   _mgr->buildStrash();
+   _cuts.enumerate(_mgr);
+   const GateList order = _cuts.getOrder();
+
+   unsigned nRewrite = 0;
+   for (size_t i = 0, n = order.size(); i < n; ++i) {
+      CirGate* g = order[i];
+      if (g->_type != AIG_GATE || !_mgr->isAlive(g)) continue;
+
+      const CirCut* cuts = _cuts.getCuts(g->_id);
+      int bestGain = 0;
+      const CirNpnClass* bestClass = 0;
+      unsigned bestPerm = 0, bestPhase = 0;
+      bool bestInv = false;
+      CirGate* bestLeaf[4];
+      for (unsigned c = 0, nc = _cuts.getNumCuts(g->_id); c < nc; ++c) {
+         const CirCut& cut = cuts[c];
+         if (cut.size() < 2 || cut.isTrivial()) continue;
+         // the cut is stale if a leaf has been rewritten away
+         _nLeaf = cut.size();
+         bool alive = true;
+         for (unsigned l = 0; l < _nLeaf && alive; ++l)
+            alive = (_leaf[l] = _mgr->getGate(cut[l])) != 0;
+         if (!alive) continue;
+
+         unsigned perm, phase;
+         bool outInv;
+         const CirNpnClass* cls =
+            npnCanonicalize(cut.getTruth() & 0xFFFF, perm, phase, outInv);
+         const int saved = derefMffc(g);
+         int added = 0;
+         const bool changed = countAdded(g, cls, perm, phase, added);
+         resetDeref();
+         if (changed && saved - added > bestGain) {
+            bestGain = saved - added; bestClass = cls;
+            bestPerm = perm; bestPhase = phase; bestInv = outInv;
+            for (unsigned l = 0; l < _nLeaf; ++l) bestLeaf[l] = _leaf[l];
+            for (unsigned l = _nLeaf; l < 4; ++l) bestLeaf[l] = 0;
+         }
+      }
+      if (!bestClass) continue;
+
+      for (_nLeaf = 0; _nLeaf < 4 && bestLeaf[_nLeaf]; ++_nLeaf)
+         _leaf[_nLeaf] = bestLeaf[_nLeaf];
+      CirGateV v = build(bestClass, bestPerm, bestPhase) ^ bestInv;
+      if (v.gate() == g) continue;
+      _mgr->replaceGate(g, v);
+      ++nRewrite;
+   }
+   _mgr->cleanGarbage();
+   return nRewrite;
+}
+
+/**************************************************************/
+/*   class CirMgr member functions for circuit optimization   */
+/**************************************************************/
+void
+CirMgr::rewrite()
+{
+  const size_t before = _aig.size();
+  CirRewriter rewriter(this);
+  unsigned n = rewriter.rewrite();
+  cout << "Rewriting: " << before << " AIG(s) -> " << _aig.size()
+       << " AIG(s) in " << n << " replacement(s)" << endl;
+}
@@ -0,0 +1,497 @@
+/****************************************************************************
+  FileName     [ cirSat.cpp ]
+  PackageName  [ cir ]
+  Synopsis     [ Define a small incremental CDCL SAT solver ]
+  Author       [ Chung-Yang (Ric) Huang ]
+  Copyright    [ Copyleft(c) 2008-present LaDs(III), GIEE, NTU, Taiwan ]
+****************************************************************************/
+
+#include <cassert>
+#include <algorithm>
+#include "cirSat.h"
+
+using namespace std;
+
+/**************************************/
+/*   Static varaibles and functions   */
+/**************************************/
+// The Luby sequence 1, 1, 2, 1, 1, 2, 4, 1, ...
+static unsigned
+luby(unsigned x)
+{
+   unsigned size = 1, seq = 0;
+   while (size < x + 1) { ++seq; size = 2 * size + 1; }
+   while (size - 1 != x) { size = (size - 1) >> 1; --seq; x = x % size; }
+   return 1u << seq;
+}
+
+/**************************************/
+/*   class SatSolver member functions */
+/**************************************/
+const unsigned SatSolver::NO_REASON;
+
+SatSolver::SatSolver()
+   : _ok(true), _wasted(0), _qhead(0), _varInc(1), _claInc(1),
+     _restricted(false),
+     _conflicts(0), _budget(0), _maxLearnts(0)
+{
+}
+
+SatVar
+SatSolver::newVar()
+{
+   const SatVar v = _value.size();
+   _value.push_back(2);
+   _level.push_back(0);
+   _reason.push_back(NO_REASON);
+   _activity.push_back(0);
+   _polarity.push_back(0);
+   _decision.push_back(!_restricted);
+   _seen.push_back(0);
+   _heapIdx.push_back(-1);
+   _watch.resize(_watch.size() + 2);
+   if (_decision[v]) heapInsert(v);
+   return v;
+}
+
+unsigned
+SatSolver::allocClause(const vector<SatLit>& lits, bool learnt)
+{
+   const unsigned c = _arena.size();
+   _arena.push_back((lits.size() << 2) | (learnt << 1));
+   _arena.push_back(0);
+   clauseAct(c) = 0;
+   _arena.insert(_arena.end(), lits.begin(), lits.end());
+   return c;
+}
+
+void
+SatSolver::attachClause(unsigned c)
+{
+   const SatLit* lits = clauseLits(c);
+   _watch[lits[0]].push_back(Watcher(c, lits[1]));
+   _watch[lits[1]].push_back(Watcher(c, lits[0]));
+}
+
+// Called at decision level 0 only
+bool
+SatSolver::addClause(vector<SatLit>& lits)
+{
+   assert(decisionLevel() == 0);
+   if (!_ok) return false;
+   sort(lits.begin(), lits.end());
+   size_t j = 0;
+   for (size_t i = 0; i < lits.size(); ++i) {
+      const char v = litValue(lits[i]);
+      if (v == 1 || (j && lits[i] == (lits[j - 1] ^ 1))) return true;
+      if (v == 0 || (j && lits[i] == lits[j - 1])) continue;
+      lits[j++] = lits[i];
+   }
+   lits.resize(j);
+   if (lits.empty()) return _ok = false;
+   if (lits.size() == 1) {
+      enqueue(lits[0], NO_REASON);
+      return _ok = (propagate() == NO_REASON);
+   }
+   const unsigned c = allocClause(lits, false);
+   _clauses.push_back(c);
+   attachClause(c);
+   return true;
+}
+
+void
+SatSolver::addAigCNF(SatVar vf, SatVar va, bool fa, SatVar vb, bool fb)
+{
+   vector<SatLit> lits;
+   lits.push_back(satLit(va, fa)); lits.push_back(satLit(vf, true));
+   addClause(lits);
+   lits.clear();
+   lits.push_back(satLit(vb, fb)); lits.push_back(satLit(vf, true));
+   addClause(lits);
+   lits.clear();
+   lits.push_back(satLit(va, !fa)); lits.push_back(satLit(vb, !fb));
+   lits.push_back(satLit(vf));
+   addClause(lits);
+}
+
+void
+SatSolver::addEqCNF(SatVar va, SatVar vb, bool inv)
+{
+   vector<SatLit> lits;
+   lits.push_back(satLit(va)); lits.push_back(satLit(vb, !inv));
+   addClause(lits);
+   lits.clear();
+   lits.push_back(satLit(va, true)); lits.push_back(satLit(vb, inv));
+   addClause(lits);
+}
+
+void
+SatSolver::enqueue(SatLit l, unsigned reason)
+{
+   const SatVar v = l >> 1;
+   assert(_value[v] == 2);
+   _value[v] = !(l & 1);
+   _level[v] = decisionLevel();
+   _reason[v] = reason;
+   _trail.push_back(l);
+}
+
+// Return the conflicting clause, or NO_REASON
+unsigned
+SatSolver::propagate()
+{
+   unsigned confl = NO_REASON;
+   while (_qhead < _trail.size()) {
+      const SatLit falseLit = _trail[_qhead++] ^ 1;
+      vector<Watcher>& ws = _watch[falseLit];
+      size_t i = 0, j = 0;
+      const size_t n = ws.size();
+      while (i < n) {
+         const Watcher w = ws[i++];
+         if (litValue(w._blocker) == 1) { ws[j++] = w; continue; }
+         if (isDeleted(w._cref)) continue;
+         SatLit* lits = clauseLits(w._cref);
+         if (lits[0] == falseLit) swap(lits[0], lits[1]);
+         const SatLit first = lits[0];
+         const Watcher nw(w._cref, first);
+         if (first != w._blocker && litValue(first) == 1) {
+            ws[j++] = nw; continue;
+         }
+         // look for a new literal to watch
+         bool found = false;
+         for (unsigned k = 2, sz = clauseSize(w._cref); k < sz; ++k)
+            if (litValue(lits[k]) != 0) {
+               lits[1] = lits[k]; lits[k] = falseLit;
+               _watch[lits[1]].push_back(nw);
+               found = true;
+               break;
+            }
+         if (found) continue;
+         ws[j++] = nw;
+         if (litValue(first) == 0) {
+            confl = w._cref;
+            _qhead = _trail.size();
+            while (i < n) ws[j++] = ws[i++];
+         }
+         else enqueue(first, w._cref);
+      }
+      ws.resize(j);
+   }
+   return confl;
+}
+
+// First UIP learning; learnt[0] is the asserting literal and learnt[1]
+// one of the highest level among the others
+void
+SatSolver::analyze(unsigned confl, vector<SatLit>& learnt, unsigned& btLevel)
+{
+   learnt.assign(1, 0);
+   int pathC = 0;
+   SatLit p = 0;
+   bool first = true;
+   size_t index = _trail.size();
+   do {
+      assert(confl != NO_REASON);
+      if (isLearnt(confl)) bumpClause(confl);
+      const SatLit* lits = clauseLits(confl);
+      for (unsigned k = first ? 0 : 1, sz = clauseSize(confl); k < sz; ++k) {
+         const SatVar v = lits[k] >> 1;
+         if (_seen[v] || _level[v] == 0) continue;
+         bumpVar(v);
+         _seen[v] = 1;
+         if (_level[v] >= decisionLevel()) ++pathC;
+         else learnt.push_back(lits[k]);
+      }
+      while (!_seen[_trail[--index] >> 1]);
+      p = _trail[index];
+      confl = _reason[p >> 1];
+      _seen[p >> 1] = 0;
+      --pathC;
+      first = false;
+   } while (pathC > 0);
+   learnt[0] = p ^ 1;
+
+   // drop the literals implied by the others
+   vector<SatLit> toClear(learnt);
+   size_t j = 1;
+   for (size_t i = 1; i < learnt.size(); ++i) {
+      const unsigned r = _reason[learnt[i] >> 1];
+      bool redundant = (r != NO_REASON);
+      if (redundant) {
+         const SatLit* lits = clauseLits(r);
+         for (unsigned k = 1, sz = clauseSize(r); k < sz && redundant; ++k) {
+            const SatVar v = lits[k] >> 1;
+            redundant = _seen[v] || _level[v] == 0;
+         }
+      }
+      if (!redundant) learnt[j++] = learnt[i];
+   }
+   learnt.resize(j);
+   for (size_t i = 0; i < toClear.size(); ++i) _seen[toClear[i] >> 1] = 0;
+
+   btLevel = 0;
+   if (learnt.size() > 1) {
+      size_t maxI = 1;
+      for (size_t i = 2; i < learnt.size(); ++i)
+         if (_level[learnt[i] >> 1] > _level[learnt[maxI] >> 1]) maxI = i;
+      swap(learnt[1], learnt[maxI]);
+      btLevel = _level[learnt[1] >> 1];
+   }
+}
+
+void
+SatSolver::cancelUntil(unsigned level)
+{
+   if (decisionLevel() <= level) return;
+   for (size_t i = _trail.size(); i-- > _trailLim[level]; ) {
+      const SatVar v = _trail[i] >> 1;
+      _polarity[v] = _value[v];
+      _value[v] = 2;
+      _reason[v] = NO_REASON;
+      if (_heapIdx[v] < 0 && _decision[v]) heapInsert(v);
+   }
+   _trail.resize(_trailLim[level]);
+   _trailLim.resize(level);
+   _qhead = _trail.size();
+}
+
+SatLit
+SatSolver::pickBranch()
+{
+   while (!_heap.empty()) {
+      const SatVar v = heapPop();
+      if (_value[v] == 2 && _decision[v]) return satLit(v, !_polarity[v]);
+   }
+   return NO_REASON;
+}
+
+// Return SAT_UNDEC on restart or when the budget is used up
+SatResult
+SatSolver::search(int nConflicts)
+{
+   int conflictC = 0;
+   vector<SatLit> learnt;
+   for (;;) {
+      const unsigned confl = propagate();
+      if (confl != NO_REASON) {
+         ++_conflicts; ++conflictC;
+         if (decisionLevel() == 0) { _ok = false; return SAT_UNSAT; }
+         unsigned btLevel;
+         analyze(confl, learnt, btLevel);
+         cancelUntil(btLevel);
+         if (learnt.size() == 1) enqueue(learnt[0], NO_REASON);
+         else {
+            const unsigned c = allocClause(learnt, true);
+            _learnts.push_back(c);
+            attachClause(c);
+            bumpClause(c);
+            enqueue(learnt[0], c);
+         }
+         _varInc *= 1 / 0.95;
+         _claInc *= 1 / 0.999f;
+         continue;
+      }
+      if (conflictC >= nConflicts || (_budget && _conflicts >= _budget)) {
+         cancelUntil(0);
+         return SAT_UNDEC;
+      }
+      if (double(_learnts.size()) >= _maxLearnts + _trail.size()) reduceDB();
+
+      SatLit next = NO_REASON;
+      while (decisionLevel() < _assumps.size()) {
+         const SatLit p = _assumps[decisionLevel()];
+         const char v = litValue(p);
+         if (v == 1) _trailLim.push_back(_trail.size());   // dummy level
+         else if (v == 0) return SAT_UNSAT;
+         else { next = p; break; }
+      }
+      if (next == NO_REASON) {
+         next = pickBranch();
+         if (next == NO_REASON) return SAT_SAT;
+      }
+      _trailLim.push_back(_trail.size());
+      enqueue(next, NO_REASON);
+   }
+}
+
+SatResult
+SatSolver::assumpSolve(unsigned confLimit)
+{
+   _model.clear();
+   if (!_ok) return SAT_UNSAT;
+   _budget = confLimit ? _conflicts + confLimit : 0;
+   if (_maxLearnts < _clauses.size() / 3.0) _maxLearnts = _clauses.size() / 3.0;
+   if (_maxLearnts < 1000) _maxLearnts = 1000;
+
+   SatResult r = SAT_UNDEC;
+   for (unsigned i = 0; r == SAT_UNDEC; ++i) {
+      r = search(100 * luby(i));
+      if (r == SAT_UNDEC && _budget && _conflicts >= _budget) break;
+      _maxLearnts *= 1.05;
+   }
+   if (r == SAT_SAT) _model.assign(_value.begin(), _value.end());
+   cancelUntil(0);
+   return r;
+}
+
+void
+SatSolver::setDecisionVars(const vector<SatVar>& vars)
+{
+   if (!_restricted) _decision.assign(_decision.size(), 0);
+   for (size_t i = 0; i < _decisionVars.size(); ++i)
+      _decision[_decisionVars[i]] = 0;
+   _decisionVars = vars;
+   for (size_t i = 0; i < vars.size(); ++i) _decision[vars[i]] = 1;
+   _restricted = true;
+   heapRebuild();
+}
+
+void
+SatSolver::clearDecisionVars()
+{
+   _decision.assign(_decision.size(), 1);
+   _decisionVars.clear();
+   _restricted = false;
+   heapRebuild();
+}
+
+struct SatActLess
+{
+   SatActLess(vector<unsigned>& a): _arena(a) {}
+   bool operator () (unsigned x, unsigned y) const {
+      return *(float*)&_arena[x + 1] < *(float*)&_arena[y + 1];
+   }
+   vector<unsigned>& _arena;
+};
+
+// Remove half of the learnt clauses, the least active ones first
+void
+SatSolver::reduceDB()
+{
+   sort(_learnts.begin(), _learnts.end(), SatActLess(_arena));
+   const size_t half = _learnts.size() / 2;
+   size_t j = 0;
+   for (size_t i = 0; i < _learnts.size(); ++i) {
+      const unsigned c = _learnts[i];
+      if (i < half && clauseSize(c) > 2 && !isLocked(c)) {
+         _arena[c] |= 1;
+         _wasted += clauseSize(c) + 2;
+      }
+      else _learnts[j++] = c;
+   }
+   _learnts.resize(j);
+   // the kept (binary or locked) clauses do not count against the limit
+   if (_maxLearnts < 2.0 * j) _maxLearnts = 2.0 * j;
+   if (_wasted > _arena.size() / 2) garbageCollect();
+}
+
+// Compact the arena; the new address of a clause is left in its old
+// activity word to relocate the reasons
+void
+SatSolver::garbageCollect()
+{
+   vector<unsigned> arena;
+   arena.reserve(_arena.size() - _wasted);
+   vector<unsigned>* lists[2] = { &_clauses, &_learnts };
+   for (unsigned l = 0; l < 2; ++l) {
+      vector<unsigned>& list = *lists[l];
+      for (size_t i = 0; i < list.size(); ++i) {
+         const unsigned c = list[i], sz = clauseSize(c) + 2;
+         const unsigned nc = arena.size();
+         arena.insert(arena.end(), _arena.begin() + c, _arena.begin() + c + sz);
+         _arena[c + 1] = nc;
+         list[i] = nc;
+      }
+   }
+   for (size_t i = 0; i < _trail.size(); ++i) {
+      unsigned& r = _reason[_trail[i] >> 1];
+      if (r != NO_REASON) r = _arena[r + 1];
+   }
+   _arena.swap(arena);
+   _wasted = 0;
+   for (size_t i = 0; i < _watch.size(); ++i) _watch[i].clear();
+   for (size_t i = 0; i < _clauses.size(); ++i) attachClause(_clauses[i]);
+   for (size_t i = 0; i < _learnts.size(); ++i) attachClause(_learnts[i]);
+}
+
+void
+SatSolver::bumpVar(SatVar v)
+{
+   if ((_activity[v] += _varInc) > 1e100) {
+      for (size_t i = 0; i < _activity.size(); ++i) _activity[i] *= 1e-100;
+      _varInc *= 1e-100;
+   }
+   if (_heapIdx[v] >= 0) heapUp(_heapIdx[v]);
+}
+
+void
+SatSolver::bumpClause(unsigned c)
+{
+   if ((clauseAct(c) += _claInc) > 1e20f) {
+      for (size_t i = 0; i < _learnts.size(); ++i)
+         clauseAct(_learnts[i]) *= 1e-20f;
+      _claInc *= 1e-20f;
+   }
+}
+
+void
+SatSolver::heapUp(unsigned i)
+{
+   const SatVar v = _heap[i];
+   while (i > 0) {
+      const unsigned p = (i - 1) >> 1;
+      if (_activity[_heap[p]] >= _activity[v]) break;
+      _heap[i] = _heap[p]; _heapIdx[_heap[i]] = i;
+      i = p;
+   }
+   _heap[i] = v; _heapIdx[v] = i;
+}
+
+void
+SatSolver::heapDown(unsigned i)
+{
+   const SatVar v = _heap[i];
+   const unsigned n = _heap.size();
+   for (;;) {
+      unsigned c = 2 * i + 1;
+      if (c >= n) break;
+      if (c + 1 < n && _activity[_heap[c + 1]] > _activity[_heap[c]]) ++c;
+      if (_activity[_heap[c]] <= _activity[v]) break;
+      _heap[i] = _heap[c]; _heapIdx[_heap[i]] = i;
+      i = c;
+   }
+   _heap[i] = v; _heapIdx[v] = i;
+}
+
+void
+SatSolver::heapInsert(SatVar v)
+{
+   _heapIdx[v] = _heap.size();
+   _heap.push_back(v);
+   heapUp(_heap.size() - 1);
+}
+
+void
+SatSolver::heapRebuild()
+{
+   for (size_t i = 0; i < _heap.size(); ++i) _heapIdx[_heap[i]] = -1;
+   _heap.clear();
+   if (!_restricted) {
+      for (SatVar v = 0; v < _value.size(); ++v)
+         if (_value[v] == 2) heapInsert(v);
+   }
+   else for (size_t i = 0; i < _decisionVars.size(); ++i)
+      if (_value[_decisionVars[i]] == 2 && _heapIdx[_decisionVars[i]] < 0)
+         heapInsert(_decisionVars[i]);
+}
+
+SatVar
+SatSolver::heapPop()
+{
+   const SatVar v = _heap[0];
+   _heapIdx[v] = -1;
+   _heap[0] = _heap.back();
+   _heap.pop_back();
+   if (!_heap.empty()) { _heapIdx[_heap[0]] = 0; heapDown(0); }
+   return v;
+}
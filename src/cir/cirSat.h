@@ -0,0 +1,142 @@
+/****************************************************************************
+  FileName     [ cirSat.h ]
+  PackageName  [ cir ]
+  Synopsis     [ Define a small incremental CDCL SAT solver ]
+  Author       [ Chung-Yang (Ric) Huang ]
+  Copyright    [ Copyleft(c) 2008-present LaDs(III), GIEE, NTU, Taiwan ]
+****************************************************************************/
+
+#ifndef CIR_SAT_H
+#define CIR_SAT_H
+
+#include <vector>
+#include <stdint.h>
+
+using namespace std;
+
+typedef unsigned SatVar;
+typedef unsigned SatLit;   // 2 * var + inverted
+
+inline SatLit satLit(SatVar v, bool inv = false) { return v * 2 + inv; }
+
+enum SatResult
+{
+   SAT_UNSAT = 0,
+   SAT_SAT   = 1,
+   SAT_UNDEC = 2      // conflict limit reached
+};
+
+//------------------------------------------------------------------------
+//   class SatSolver
+//------------------------------------------------------------------------
+// Conflict-driven clause learning with two watched literals, 1UIP
+// learning, VSIDS, phase saving and Luby restarts.  Clauses can be added
+// between calls; assumptions hold for the next call only.
+class SatSolver
+{
+public:
+   SatSolver();
+
+   SatVar newVar();
+   unsigned getNumVars() const { return _value.size(); }
+   uint64_t getNumConflicts() const { return _conflicts; }
+
+   // return false if the clause set has become unsatisfiable
+   bool addClause(vector<SatLit>&);
+   // vf = (va ^ fa) & (vb ^ fb)
+   void addAigCNF(SatVar vf, SatVar va, bool fa, SatVar vb, bool fb);
+   // va = vb ^ inv
+   void addEqCNF(SatVar va, SatVar vb, bool inv);
+
+   // Branch only on these variables in the following calls; any assignment
+   // of them without conflict must extend to a model (e.g. the PIs and
+   // gates of AIG cones)
+   void setDecisionVars(const vector<SatVar>&);
+   void clearDecisionVars();
+
+   void assumeRelease() { _assumps.clear(); }
+   void assumeProperty(SatVar v, bool val) { _assumps.push_back(satLit(v, !val)); }
+   // confLimit 0 means no limit
+   SatResult assumpSolve(unsigned confLimit = 0);
+   // value of v in the last satisfying assignment, -1 if unassigned
+   int getValue(SatVar v) const { return _model[v] == 2 ? -1 : _model[v]; }
+
+private:
+   struct Watcher {
+      Watcher(unsigned c = 0, SatLit b = 0): _cref(c), _blocker(b) {}
+      unsigned _cref;
+      SatLit   _blocker;
+   };
+
+   bool                        _ok;
+   // clause arena: [size << 2 | learnt << 1 | deleted][activity][lits...]
+   vector<unsigned>            _arena;
+   vector<unsigned>            _clauses;
+   vector<unsigned>            _learnts;
+   size_t                      _wasted;
+   vector<vector<Watcher> >    _watch;     // indexed by literal
+   // assignment
+   vector<char>                _value;     // 0, 1 or 2 (unassigned)
+   vector<unsigned>            _level;
+   vector<unsigned>            _reason;
+   vector<SatLit>              _trail;
+   vector<unsigned>            _trailLim;
+   size_t                      _qhead;
+   // decision heuristics
+   vector<double>              _activity;
+   double                      _varInc;
+   float                       _claInc;
+   vector<char>                _polarity;
+   vector<char>                _decision;
+   vector<SatVar>              _decisionVars;
+   bool                        _restricted;
+   vector<int>                 _heapIdx;
+   vector<SatVar>              _heap;
+   // others
+   vector<char>                _seen;
+   vector<SatLit>              _assumps;
+   vector<char>                _model;
+   uint64_t                    _conflicts;
+   uint64_t                    _budget;
+   double                      _maxLearnts;
+
+   static const unsigned NO_REASON = ~0u;
+
+   unsigned clauseSize(unsigned c) const { return _arena[c] >> 2; }
+   bool isLearnt(unsigned c) const { return _arena[c] & 2; }
+   bool isDeleted(unsigned c) const { return _arena[c] & 1; }
+   float& clauseAct(unsigned c) { return *(float*)&_arena[c + 1]; }
+   SatLit* clauseLits(unsigned c) { return &_arena[c + 2]; }
+   bool isLocked(unsigned c) {
+      const SatLit l = clauseLits(c)[0];
+      return _reason[l >> 1] == c && litValue(l) == 1;
+   }
+
+   // 1 true, 0 false, 2 unassigned
+   char litValue(SatLit l) const {
+      const char v = _value[l >> 1];
+      return (v == 2) ? 2 : (v ^ char(l & 1));
+   }
+   unsigned decisionLevel() const { return _trailLim.size(); }
+
+   unsigned allocClause(const vector<SatLit>&, bool learnt);
+   void attachClause(unsigned c);
+   void enqueue(SatLit, unsigned reason);
+   unsigned propagate();
+   void analyze(unsigned confl, vector<SatLit>& learnt, unsigned& btLevel);
+   void cancelUntil(unsigned level);
+   SatLit pickBranch();
+   SatResult search(int nConflicts);
+   void reduceDB();
+   void garbageCollect();
+
+   void bumpVar(SatVar);
+   void bumpClause(unsigned c);
+   void heapUp(unsigned i);
+   void heapDown(unsigned i);
+   void heapInsert(SatVar);
+   void heapRebuild();
+   SatVar heapPop();
+};
+
+#endif // CIR_SAT_H
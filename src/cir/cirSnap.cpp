@@ -0,0 +1,163 @@
+/****************************************************************************
+  FileName     [ cirSnap.cpp ]
+  PackageName  [ cir ]
+  Synopsis     [ Define copy-on-write circuit snapshots ]
+  Author       [ Chung-Yang (Ric) Huang ]
+  Copyright    [ Copyleft(c) 2008-present LaDs(III), GIEE, NTU, Taiwan ]
+****************************************************************************/
+
+#include <iostream>
+#include <iomanip>
+#include <sstream>
+#include <cassert>
+#include "cirMgr.h"
+#include "cirGate.h"
+#include "util.h"
+#include "myWriter.h"
+
+using namespace std;
+
+/**************************************************************/
+/*   class CirMgr member functions for snapshots              */
+/**************************************************************/
+// Save the connections of g before its first edit since the last snapshot.
+// Called by every netlist editing function.
+void
+CirMgr::touch(CirGate* g)
+{
+  timingDirty(g);
+  if (_snapshots.empty()) return;
+  CirSnapshot* s = _snapshots.back();
+  if (g->_cowStamp == s->_serial) return;
+  g->_cowStamp = s->_serial;
+  s->_saved.push_back(CirGateState());
+  CirGateState& st = s->_saved.back();
+  st._gate = g;
+  st._fanin = g->_fanin;
+  st._invert = g->_invert;
+  st._fanout = g->_fanout;
+}
+
+// Taking a snapshot only opens a new, empty journal
+bool
+CirMgr::takeSnapshot(const string& name)
+{
+  for (size_t i = 0; i < _snapshots.size(); i++)
+    if (_snapshots[i]->_name == name) return false;
+  cleanGarbage();
+  CirSnapshot* s = new CirSnapshot;
+  s->_name = name;
+  s->_serial = ++_cowSerial;
+  s->_nextId = _nextId;
+  s->_nAig = _aig.size();
+  s->_aigSaved = false;
+  s->_netState = _netState;
+  s->_strashLost = false;
+  _snapshots.push_back(s);
+  return true;
+}
+
+// Undo the edits journaled in s, and empty the journal.  This takes time
+// in the size of the journal, not of the circuit, unless the strash table
+// has been built since s.
+void
+CirMgr::undoSnapshot(CirSnapshot* s)
+{
+  for (size_t i = s->_removed.size(); i-- > 0; ) {
+    _map[s->_removed[i]->_id] = s->_removed[i];
+    timingDirty(s->_removed[i]);
+  }
+  for (size_t i = s->_saved.size(); i-- > 0; ) {
+    CirGateState& st = s->_saved[i];
+    st._gate->_fanin.swap(st._fanin);
+    st._gate->_invert.swap(st._invert);
+    st._gate->_fanout.swap(st._fanout);
+    timingDirty(st._gate);
+  }
+  if (s->_strashLost) {
+    _strash.clear();
+    _strashBuilt = false;
+  }
+  else if (_strashBuilt)
+    for (size_t i = s->_strashLog.size(); i-- > 0; ) {
+      const pair<size_t, CirGate*>& e = s->_strashLog[i];
+      if (e.second) _strash[e.first] = e.second;
+      else _strash.erase(e.first);
+    }
+  for (size_t i = 0; i < s->_created.size(); i++) {
+    CirGate* g = s->_created[i];
+    map<unsigned, CirGate*>::iterator it = _map.find(g->_id);
+    if (it != _map.end() && it->second == g) _map.erase(it);
+    delete g;
+  }
+  if (s->_aigSaved) _aig.swap(s->_aig);
+  else _aig.resize(s->_nAig);
+  _nextId = s->_nextId;
+
+  s->_saved.clear();
+  s->_created.clear();
+  s->_removed.clear();
+  s->_aig.clear();
+  s->_aigSaved = false;
+  s->_strashLog.clear();
+  s->_strashLost = false;
+}
+
+// Roll back to the named snapshot, or the latest one if name is empty.
+// The snapshots taken after it are dropped.
+bool
+CirMgr::restoreSnapshot(const string& name)
+{
+  size_t k = _snapshots.size();
+  if (name == "") k = _snapshots.size() - 1;
+  else for (size_t i = 0; i < _snapshots.size(); i++)
+    if (_snapshots[i]->_name == name) k = i;
+  if (k >= _snapshots.size()) return false;
+
+  // the gates removed since the last clean-up belong to the latest journal
+  CirSnapshot* last = _snapshots.back();
+  last->_removed.insert(last->_removed.end(), _garbage.begin(), _garbage.end());
+  _garbage.clear();
+  while (_snapshots.size() > k + 1) {
+    undoSnapshot(_snapshots.back());
+    delete _snapshots.back();
+    _snapshots.pop_back();
+  }
+  undoSnapshot(_snapshots[k]);
+  // the gates saved in this journal must be saved again
+  _snapshots[k]->_serial = ++_cowSerial;
+
+  // the caches are valid if they were built from the restored netlist;
+  // the timing is updated from the restored gates
+  _netState = _snapshots[k]->_netState;
+  _dfsValid = _dfsState == _netState;
+  _csrValid = _csrState == _netState;
+  return true;
+}
+
+// Keep the current circuit and free all the journals
+void
+CirMgr::clearSnapshots()
+{
+  cleanGarbage();
+  for (size_t i = 0; i < _snapshots.size(); i++) {
+    for (size_t j = 0; j < _snapshots[i]->_removed.size(); j++)
+      delete _snapshots[i]->_removed[j];
+    delete _snapshots[i];
+  }
+  _snapshots.clear();
+}
+
+void
+CirMgr::printSnapshots() const
+{
+  MyWriter out(cout);
+  for (size_t i = 0; i < _snapshots.size(); i++) {
+    const CirSnapshot* s = _snapshots[i];
+    out << "[" << i << "] ";
+    out.left(s->_name, 12) << " ";
+    out.right(s->_saved.size(), 8) << " saved, ";
+    out.right(s->_created.size(), 8) << " created, ";
+    out.right(s->_removed.size(), 8) << " removed gate(s)" << '\n';
+  }
+}
@@ -0,0 +1,301 @@
+/****************************************************************************
+  FileName     [ cirTiming.cpp ]
+  PackageName  [ cir ]
+  Synopsis     [ Define static timing analysis ]
+  Author       [ Chung-Yang (Ric) Huang ]
+  Copyright    [ Copyleft(c) 2008-present LaDs(III), GIEE, NTU, Taiwan ]
+****************************************************************************/
+
+#include <cassert>
+#include <iostream>
+#include <iomanip>
+#include <sstream>
+#include <algorithm>
+#include <queue>
+#include "cirMgr.h"
+#include "cirGate.h"
+#include "util.h"
+
+using namespace std;
+
+/**************************************/
+/*   Static varaibles and functions   */
+/**************************************/
+// Above this fraction of touched gates, the timing is built again
+#define TIMING_REBUILD_RATIO   4
+#define TIMING_HIST_BAR        40
+
+// No path to a PO
+static const double noPath = -1;
+
+// Arrival times, levels and the longest delays to a PO, by gate id.
+// required = period - _tail and slack = required - arrival; keeping _tail
+// instead of the required time makes it independent of the period, so an
+// edit that changes the largest arrival time does not touch every gate.
+struct CirMgr::CirTiming
+{
+   CirDelayModel      _model;
+   vector<double>     _arrival;
+   vector<unsigned>   _level;
+   vector<double>     _tail;
+   size_t             _nUpdated;   // gates computed by the last update
+   bool               _rebuilt;    // the last update was not incremental
+
+   void resize(unsigned n) {
+      if (_arrival.size() >= n) return;
+      _arrival.resize(n, 0);
+      _level.resize(n, 0);
+      _tail.resize(n, noPath);
+   }
+   double gateDelay(const CirGate* g) const {
+      switch (g->_type) {
+         case PI_GATE:  return _model._pi;
+         case AIG_GATE: return _model._aig;
+         case PO_GATE:  return _model._po;
+         default:       return 0;
+      }
+   }
+   double edgeDelay(const CirGate* g, size_t i) const {
+      return g->_invert[i] ? _model._inv : 0;
+   }
+   // from the fanins; true if it changes
+   bool updateArrival(const CirGate* g) {
+      double a = 0;
+      unsigned l = 0;
+      for (size_t i = 0; i < g->_fanin.size(); i++) {
+         const unsigned f = g->_fanin[i]->_id;
+         a = max(a, _arrival[f] + edgeDelay(g, i));
+         l = max(l, _level[f] + 1);
+      }
+      a += gateDelay(g);
+      if (a == _arrival[g->_id] && l == _level[g->_id]) return false;
+      _arrival[g->_id] = a;
+      _level[g->_id] = l;
+      return true;
+   }
+   // from the fanouts; true if it changes
+   bool updateTail(const CirGate* g) {
+      double t = g->_type == PO_GATE ? 0 : noPath;
+      for (size_t i = 0; i < g->_fanout.size(); i++) {
+         const CirGate* fo = g->_fanout[i];
+         if (_tail[fo->_id] == noPath) continue;
+         for (size_t j = 0; j < fo->_fanin.size(); j++)
+            if (fo->_fanin[j] == g)
+               t = max(t, _tail[fo->_id] + gateDelay(fo) + edgeDelay(fo, j));
+      }
+      if (t == _tail[g->_id]) return false;
+      _tail[g->_id] = t;
+      return true;
+   }
+};
+
+/*******************************************************/
+/*   class CirMgr member functions for timing analysis  */
+/*******************************************************/
+void
+CirMgr::clearTiming()
+{
+  delete _timing;
+  _timing = 0;
+  _timingDirty.clear();
+}
+
+// All the gates, dangling ones included, fanins first
+void
+CirMgr::buildTiming()
+{
+  CirTiming& t = *_timing;
+  const unsigned nIds = getGateIdEnd();
+  t._arrival.assign(nIds, 0);
+  t._level.assign(nIds, 0);
+  t._tail.assign(nIds, noPath);
+
+  GateList order;
+  order.reserve(_map.size());
+  CirTravContext ctx(nIds);
+  vector<pair<const CirGate*, size_t> > stack;
+  for (map<unsigned, CirGate*>::const_iterator it = _map.begin();
+       it != _map.end(); ++it) {
+    if (ctx.isMarked(it->second)) continue;
+    ctx.mark(it->second);
+    stack.push_back(make_pair(it->second, 0));
+    while (!stack.empty()) {
+      const CirGate* g = stack.back().first;
+      const size_t j = stack.back().second++;
+      if (j < g->_fanin.size()) {
+        const CirGate* f = g->_fanin[j];
+        if (!ctx.isMarked(f)) {
+          ctx.mark(f);
+          stack.push_back(make_pair(f, 0));
+        }
+        continue;
+      }
+      stack.pop_back();
+      order.push_back(const_cast<CirGate*>(g));
+    }
+  }
+  for (size_t i = 0; i < order.size(); i++) t.updateArrival(order[i]);
+  for (size_t i = order.size(); i-- > 0; ) t.updateTail(order[i]);
+  t._nUpdated = order.size();
+  t._rebuilt = true;
+}
+
+// Bring the timing up to date with the netlist.  After edits, the touched
+// gates are updated level by level: the arrival times forward through the
+// fanouts and the tails backward through the fanins, each only as far as
+// the values change.
+void
+CirMgr::updateTiming(const CirDelayModel& model)
+{
+  if (_timing && (_timing->_model != model ||
+                  _timingDirty.size() * TIMING_REBUILD_RATIO > _map.size()))
+    clearTiming();
+  if (!_timing) {
+    _timing = new CirTiming;
+    _timing->_model = model;
+    buildTiming();
+    return;
+  }
+
+  CirTiming& t = *_timing;
+  t.resize(getGateIdEnd());
+  t._nUpdated = 0;
+  t._rebuilt = false;
+  typedef pair<unsigned, unsigned> LevelId;
+  priority_queue<LevelId, vector<LevelId>, greater<LevelId> > fwd;
+  priority_queue<LevelId> bwd;
+  vector<char> queued(t._arrival.size(), 0);
+  IdList dirty;
+  dirty.swap(_timingDirty);
+  sort(dirty.begin(), dirty.end());
+  dirty.erase(unique(dirty.begin(), dirty.end()), dirty.end());
+  for (size_t i = 0; i < dirty.size(); i++) {
+    CirGate* g = getGate(dirty[i]);
+    if (!g) continue;
+    // the level of a new gate is still 0
+    unsigned l = 0;
+    for (size_t j = 0; j < g->_fanin.size(); j++)
+      l = max(l, t._level[g->_fanin[j]->_id] + 1);
+    fwd.push(LevelId(l, g->_id));
+    queued[g->_id] = 1;
+  }
+
+  // a gate may be popped again if a fanin of a lower level changes later
+  while (!fwd.empty()) {
+    CirGate* g = getGate(fwd.top().second);
+    fwd.pop();
+    queued[g->_id] = 0;
+    ++t._nUpdated;
+    if (!t.updateArrival(g)) continue;
+    for (size_t i = 0; i < g->_fanout.size(); i++) {
+      const unsigned fo = g->_fanout[i]->_id;
+      if (queued[fo]) continue;
+      fwd.push(LevelId(t._level[g->_id] + 1, fo));
+      queued[fo] = 1;
+    }
+  }
+  // the tails only change with the fanout edges, i.e. at the touched gates
+  for (size_t i = 0; i < dirty.size(); i++)
+    if (getGate(dirty[i])) {
+      bwd.push(LevelId(t._level[dirty[i]], dirty[i]));
+      queued[dirty[i]] = 1;
+    }
+  while (!bwd.empty()) {
+    CirGate* g = getGate(bwd.top().second);
+    bwd.pop();
+    queued[g->_id] = 0;
+    ++t._nUpdated;
+    if (!t.updateTail(g)) continue;
+    for (size_t i = 0; i < g->_fanin.size(); i++) {
+      const unsigned f = g->_fanin[i]->_id;
+      if (queued[f]) continue;
+      bwd.push(LevelId(t._level[f], f));
+      queued[f] = 1;
+    }
+  }
+}
+
+/**************************************************************/
+/*   class CirMgr member functions for timing reporting       */
+/**************************************************************/
+// The largest arrival time is required at the POs unless period > 0.
+// nPaths critical paths are traced from the POs of the least slack, each
+// back through the fanin of the latest arrival; the histogram counts the
+// gates on paths to the POs by their slack.
+void
+CirMgr::reportTiming(unsigned nPaths, unsigned nBins, double period) const
+{
+  assert(_timing);
+  const CirTiming& t = *_timing;
+  const CirDelayModel& m = t._model;
+  double maxArrival = 0;
+  for (size_t i = 0; i < _po.size(); i++)
+    maxArrival = max(maxArrival, t._arrival[_po[i]->_id]);
+  const double required = period > 0 ? period : maxArrival;
+
+  cout << "Delay model: PI " << m._pi << ", AIG " << m._aig << ", PO "
+       << m._po << ", inverter " << m._inv << endl;
+  cout << "Updated " << t._nUpdated << " gate(s)"
+       << (t._rebuilt ? "" : " incrementally") << endl;
+  cout << "Max arrival time  " << maxArrival << endl
+       << "Required time     " << required << endl;
+  if (_po.empty()) return;
+
+  GateList po(_po);
+  stable_sort(po.begin(), po.end(), [&](const CirGate* a, const CirGate* b) {
+    return t._arrival[a->_id] > t._arrival[b->_id]; });
+  cout << "Worst slack       " << required - t._arrival[po[0]->_id] << endl;
+
+  for (unsigned p = 0; p < nPaths && p < po.size(); p++) {
+    cout << endl << "Critical path " << p + 1 << ": PO " << po[p]->_id;
+    if (po[p]->_name.size()) cout << " (" << po[p]->_name << ")";
+    cout << ", slack " << required - t._arrival[po[p]->_id] << endl;
+    GateList path;
+    vector<bool> inv;   // of the edge from path[i] to path[i - 1]
+    const CirGate* g = po[p];
+    for (bool in = false; ; ) {
+      path.push_back(const_cast<CirGate*>(g));
+      inv.push_back(in);
+      if (g->_fanin.empty()) break;
+      size_t k = 0;
+      for (size_t j = 1; j < g->_fanin.size(); j++)
+        if (t._arrival[g->_fanin[j]->_id] + t.edgeDelay(g, j) >
+            t._arrival[g->_fanin[k]->_id] + t.edgeDelay(g, k)) k = j;
+      in = g->_invert[k];
+      g = g->_fanin[k];
+    }
+    for (size_t i = path.size(); i-- > 0; ) {
+      g = path[i];
+      cout << "  " << setw(8) << right << t._arrival[g->_id] << "  "
+           << (inv[i] ? "!" : " ") << g->getTypeStr() << " " << g->_id;
+      if (g->_name.size()) cout << " (" << g->_name << ")";
+      cout << endl;
+    }
+  }
+
+  if (!nBins) return;
+  vector<double> slack;
+  for (map<unsigned, CirGate*>::const_iterator it = _map.begin();
+       it != _map.end(); ++it) {
+    const unsigned id = it->first;
+    if (t._tail[id] != noPath)
+      slack.push_back(required - t._arrival[id] - t._tail[id]);
+  }
+  if (slack.empty()) return;
+  const double lo = *min_element(slack.begin(), slack.end());
+  const double hi = *max_element(slack.begin(), slack.end());
+  const double width = hi > lo ? (hi - lo) / nBins : 1;
+  vector<size_t> count(nBins, 0);
+  for (size_t i = 0; i < slack.size(); i++)
+    count[min<size_t>((slack[i] - lo) / width, nBins - 1)]++;
+  const size_t most = *max_element(count.begin(), count.end());
+  cout << endl << "Slack histogram (" << slack.size() << " gate(s))" << endl;
+  for (unsigned b = 0; b < nBins; b++) {
+    ostringstream range;
+    range << "[" << lo + b * width << ", " << lo + (b + 1) * width
+          << (b + 1 == nBins ? "]" : ")");
+    cout << "  " << setw(22) << left << range.str() << right << setw(10)
+         << count[b] << " " << string(count[b] * TIMING_HIST_BAR / most, '*')
+         << endl;
+  }
+}
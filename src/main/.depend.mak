@@ -1 +1,8 @@
-main.o: main.cpp ../../include/cmdParser.h ../../include/cmdCharDef.h
+main.o: main.cpp ../../include/util.h ../../include/rnGen.h \
+ ../../include/myUsage.h ../../include/myProfiler.h \
+ ../../include/myPerf.h ../../include/cmdParser.h \
+ ../../include/cmdCharDef.h
+server.o: server.cpp ../../include/util.h ../../include/rnGen.h \
+ ../../include/myUsage.h ../../include/myProfiler.h \
+ ../../include/myPerf.h ../../include/cmdParser.h \
+ ../../include/cmdCharDef.h
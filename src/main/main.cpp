@@ -7,6 +7,8 @@
 ****************************************************************************/
 
 #include <cstdlib>
+#include <sstream>
+#include <algorithm>
 #include "util.h"
 #include "cmdParser.h"
 
@@ -19,11 +21,17 @@ CmdParser* cmdMgr = new CmdParser("cir> ");
 
 extern bool initCommonCmd();
 extern bool initCirCmd();
+extern bool runServer(const string& path);
+
+#define BATCH_MAX_DEPTH   1024   // nesting of DOfile in batch mode
 
 static void
 usage()
 {
-   cout << "Usage: cirTest [ -File < doFile > ]" << endl;
+   cout << "Usage: cirTest [ -File < doFile > ]" << endl
+        << "       cirTest -Batch [ < cmdFile > ]" << endl
+        << "       cirTest -c \"< cmd >[; < cmd >...]\"" << endl
+        << "       cirTest -Server < socket >" << endl;
 }
 
 static void
@@ -33,24 +41,103 @@ myexit()
    exit(-1);
 }
 
+//----------------------------------------------------------------------
+//    Batch mode
+//----------------------------------------------------------------------
+// Commands are executed as they are read, without the line editing, the
+// history, the prompt and the blank line after each command of
+// CmdParser::execOneCmd().  A DOfile runs its file in batch mode, too.
+// CIRBATch runs its dofile on each circuit by runBatch() as well.
+//
+// failed is set once a command fails, also in a DOfile, and stays set
+// when a later "quit" ends the script.
+CmdExecStatus runBatch(istream& is, unsigned depth, bool& failed);
+
+CmdExecStatus
+execBatchCmd(const string& line, unsigned depth, bool& failed)
+{
+   string cmd;
+   size_t pos = myStrGetTok(line, cmd);
+   if (cmd.empty()) return CMD_EXEC_NOP;
+   CmdExec* e = cmdMgr->getCmd(cmd);
+   if (!e) {
+      cerr << "Illegal command!! (" << cmd << ")" << endl;
+      return CMD_EXEC_ERROR;
+   }
+   string option;
+   if (pos != string::npos) {
+      pos = line.find_first_not_of(' ', pos);
+      if (pos != string::npos) option = line.substr(pos);
+   }
+   if (e != cmdMgr->getCmd("DOfile")) return e->exec(option);
+
+   string file;
+   if (myStrGetTok(option, file) != string::npos) {
+      cerr << "Error: Extra option!! (" << option.substr(file.size()) << ")"
+           << endl;
+      return CMD_EXEC_ERROR;
+   }
+   ifstream dof(file.c_str());
+   if (file.empty() || !dof || depth >= BATCH_MAX_DEPTH) {
+      cerr << "Error: cannot open file \"" << file << "\"!!" << endl;
+      return CMD_EXEC_ERROR;
+   }
+   return runBatch(dof, depth + 1, failed);
+}
+
+// Until "quit" or the end of is; any failed command makes it an error
+CmdExecStatus
+runBatch(istream& is, unsigned depth, bool& failed)
+{
+   CmdExecStatus status = CMD_EXEC_DONE;
+   string line;
+   while (getline(is, line)) {
+      for (size_t i = 0; i < line.size(); ++i)
+         if (line[i] == '\t' || line[i] == '\r') line[i] = ' ';
+      const CmdExecStatus s = execBatchCmd(line, depth, failed);
+      if (s == CMD_EXEC_ERROR) failed = true;
+      if (s == CMD_EXEC_QUIT) return s;
+      if (s == CMD_EXEC_ERROR) status = s;
+   }
+   return status;
+}
+
 int
 main(int argc, char** argv)
 {
    myUsage.reset();
 
    ifstream dof;
+   bool batch = false;
+   string script;  // commands of -c, one per line
+   string server;  // socket of -Server
 
-   if (argc == 3) {  // -file <doFile>
-      if (myStrNCmp("-File", argv[1], 2) == 0) {
-         if (!cmdMgr->openDofile(argv[2])) {
+   if (argc == 3 && myStrNCmp("-File", argv[1], 2) == 0) {  // -file <doFile>
+      if (!cmdMgr->openDofile(argv[2])) {
+         cerr << "Error: cannot open file \"" << argv[2] << "\"!!\n";
+         myexit();
+      }
+   }
+   else if (argc == 3 && string(argv[1]) == "-c") {  // -c "cmd; cmd"
+      batch = true;
+      script = argv[2];
+      replace(script.begin(), script.end(), ';', '\n');
+   }
+   else if (argc == 3 && myStrNCmp("-Server", argv[1], 2) == 0)
+      server = argv[2];
+   else if ((argc == 2 || argc == 3) && myStrNCmp("-Batch", argv[1], 2) == 0) {
+      batch = true;
+      if (argc == 3) {
+         dof.open(argv[2]);
+         if (!dof) {
             cerr << "Error: cannot open file \"" << argv[2] << "\"!!\n";
             myexit();
          }
       }
-      else {
-         cerr << "Error: unknown argument \"" << argv[1] << "\"!!\n";
-         myexit();
-      }
+   }
+   else if (argc == 2 || argc == 3) {
+      cerr << "Error: unknown argument \"" << argv[1] << "\"!!\n";
+      myexit();
    }
    else if (argc != 1) {
       cerr << "Error: illegal number of argument (" << argc << ")!!\n";
@@ -60,6 +147,17 @@ main(int argc, char** argv)
    if (!initCommonCmd() || !initCirCmd())
       return 1;
 
+   if (server.size())
+      return runServer(server) ? 0 : 1;
+   if (batch) {
+      istringstream cmds(script);
+      istream& is = script.size() ? (istream&)cmds :
+                    dof.is_open() ? (istream&)dof : cin;
+      bool failed = false;
+      runBatch(is, 0, failed);
+      return failed ? 1 : 0;
+   }
+
    CmdExecStatus status = CMD_EXEC_DONE;
    while (status != CMD_EXEC_QUIT) {  // until "quit" or command error
       status = cmdMgr->execOneCmd();
@@ -0,0 +1,307 @@
+/****************************************************************************
+  FileName     [ server.cpp ]
+  PackageName  [ main ]
+  Synopsis     [ Define the command server over a Unix domain socket ]
+  Author       [ Chung-Yang (Ric) Huang ]
+  Copyright    [ Copyleft(c) 2007-present LaDs(III), GIEE, NTU, Taiwan ]
+****************************************************************************/
+
+#include <cerrno>
+#include <csignal>
+#include <cstring>
+#include <iostream>
+#include <string>
+#include <vector>
+#include <set>
+#include <unistd.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+#include <sys/wait.h>
+#include "util.h"
+#include "cmdParser.h"
+
+using namespace std;
+
+extern CmdExecStatus execBatchCmd(const string& line, unsigned depth,
+                                  bool& failed);
+
+//----------------------------------------------------------------------
+//    Command server
+//----------------------------------------------------------------------
+// Each line a client sends is one command; its output (stdout and stderr)
+// is sent back, followed by the line "%% done", "%% error" or "%% nop".
+// "quit" is answered by "%% quit" and closes the connection; SIGINT or
+// SIGTERM stops the server.
+//
+// The commands that do not change the circuits run in a forked child on
+// a copy-on-write image of the workspace, so the queries of the clients
+// run together; the others run one at a time in the server itself, and
+// the queries forked before them still see the circuits as they were.
+// The commands of a client always run in the order they are sent.
+//
+#define SERVER_BACKLOG   16
+#define SERVER_READ      4096
+
+// HIStory is not here: the commands of the clients do not go through the
+// history of CmdParser, so it has nothing to report in a child either
+static const char* serverQueryCmds[] = {
+   "HELp", "USAGE", "CIRPrint", "CIRGate", "CIRWrite", "CIRMap", "CIRCEC",
+   "CIRList", "CIRGENerate", "CIRTiming", "CIRPOwer", "CIRFault"
+};
+
+// CIRTiming keeps the delay model it is given for the later calls, so a
+// call that sets the model runs in the server
+static bool
+setsTimingModel(const string& line)
+{
+   static const char* opts[] = { "-Unit", "-PI", "-AIG", "-PO", "-INV" };
+   static const unsigned nMand[] = { 2, 3, 2, 3, 2 };
+   string tok;
+   size_t pos = myStrGetTok(line, tok);
+   while (pos != string::npos) {
+      pos = myStrGetTok(line, tok, pos);
+      for (size_t k = 0; k < sizeof(opts) / sizeof(char*); ++k)
+         if (tok.size() && myStrNCmp(opts[k], tok, nMand[k]) == 0)
+            return true;
+   }
+   return false;
+}
+
+static volatile sig_atomic_t serverStop = 0;
+
+static void
+serverSignal(int)
+{
+   serverStop = 1;
+}
+
+struct ServerConn
+{
+   ServerConn(int fd): _fd(fd), _pid(-1), _done(-1), _eof(false),
+      _quit(false) {}
+
+   // closed after the lines received before the end of its input
+   bool isOver() const {
+      return _pid < 0 && (_quit || (_eof && _in.find('\n') == string::npos));
+   }
+
+   int      _fd;
+   string   _in;       // received and not yet run
+   pid_t    _pid;      // the running query, or -1
+   int      _done;     // hangs up when the query exits
+   bool     _eof;
+   bool     _quit;
+};
+
+static bool
+sendAll(int fd, const string& s)
+{
+   for (size_t n = 0; n < s.size(); ) {
+      const ssize_t k = send(fd, s.data() + n, s.size() - n, MSG_NOSIGNAL);
+      if (k < 0 && errno == EINTR) continue;
+      if (k <= 0) return false;
+      n += k;
+   }
+   return true;
+}
+
+static void
+sendStatus(ServerConn& c, int status)
+{
+   const char* s = status == CMD_EXEC_DONE ? "done" :
+                   status == CMD_EXEC_NOP ? "nop" :
+                   status == CMD_EXEC_QUIT ? "quit" : "error";
+   if (!sendAll(c._fd, string("%% ") + s + "\n")) c._quit = true;
+}
+
+// stdout and stderr go to fd while the command runs
+static CmdExecStatus
+runRedirected(int fd, const string& line)
+{
+   cout.flush();
+   const int out = dup(1), err = dup(2);
+   dup2(fd, 1);
+   dup2(fd, 2);
+   bool failed = false;
+   const CmdExecStatus status = execBatchCmd(line, 0, failed);
+   cout.flush();
+   dup2(out, 1);
+   dup2(err, 2);
+   close(out);
+   close(err);
+   // a client that hung up fails the writes, not the server
+   cout.clear();
+   cerr.clear();
+   return status;
+}
+
+// Run the received lines of c until it waits for a query or has no line;
+// lfd and conns are closed in the forked queries
+static void
+serveLines(ServerConn& c, const set<const CmdExec*>& queries, int lfd,
+           const vector<ServerConn>& conns)
+{
+   size_t eol;
+   while (c._pid < 0 && !c._quit && (eol = c._in.find('\n')) != string::npos) {
+      string line = c._in.substr(0, eol);
+      c._in.erase(0, eol + 1);
+      for (size_t i = 0; i < line.size(); ++i)
+         if (line[i] == '\t' || line[i] == '\r') line[i] = ' ';
+      string cmd;
+      myStrGetTok(line, cmd);
+      const CmdExec* e = cmd.empty() ? 0 : cmdMgr->getCmd(cmd);
+      if (e && e == cmdMgr->getCmd("Quit")) {
+         sendStatus(c, CMD_EXEC_QUIT);
+         c._quit = true;
+         break;
+      }
+      if (!e || !queries.count(e) ||
+          (e == cmdMgr->getCmd("CIRTiming") && setsTimingModel(line))) {
+         sendStatus(c, runRedirected(c._fd, line));
+         continue;
+      }
+      int done[2];
+      if (pipe(done) < 0) {
+         sendStatus(c, runRedirected(c._fd, line));
+         continue;
+      }
+      cout.flush();
+      c._pid = fork();
+      if (c._pid == 0) {
+         // the other clients see the end of their connection only when
+         // no process holds its socket
+         close(lfd);
+         for (size_t i = 0; i < conns.size(); ++i) {
+            if (&conns[i] == &c) continue;
+            close(conns[i]._fd);
+            if (conns[i]._done >= 0) close(conns[i]._done);
+         }
+         close(done[0]);
+         dup2(c._fd, 1);
+         dup2(c._fd, 2);
+         bool failed = false;
+         const CmdExecStatus status = execBatchCmd(line, 0, failed);
+         cout.flush();
+         _exit(status);
+      }
+      close(done[1]);
+      if (c._pid < 0) {
+         close(done[0]);
+         sendStatus(c, runRedirected(c._fd, line));
+         continue;
+      }
+      c._done = done[0];
+   }
+}
+
+// Serve until SIGINT or SIGTERM; false if the socket cannot be set up
+bool
+runServer(const string& path)
+{
+   struct sockaddr_un addr;
+   memset(&addr, 0, sizeof(addr));
+   addr.sun_family = AF_UNIX;
+   if (path.size() >= sizeof(addr.sun_path)) {
+      cerr << "Error: socket path \"" << path << "\" is too long!!" << endl;
+      return false;
+   }
+   strcpy(addr.sun_path, path.c_str());
+   // a socket left by a server that was killed is replaced
+   struct stat st;
+   if (stat(path.c_str(), &st) == 0 && S_ISSOCK(st.st_mode))
+      unlink(path.c_str());
+   const int lfd = socket(AF_UNIX, SOCK_STREAM, 0);
+   if (lfd < 0 || bind(lfd, (struct sockaddr*)&addr, sizeof(addr)) < 0 ||
+       listen(lfd, SERVER_BACKLOG) < 0) {
+      cerr << "Error: cannot listen on \"" << path << "\" ("
+           << strerror(errno) << ")!!" << endl;
+      if (lfd >= 0) close(lfd);
+      return false;
+   }
+
+   set<const CmdExec*> queries;
+   for (size_t i = 0; i < sizeof(serverQueryCmds) / sizeof(char*); ++i) {
+      const CmdExec* e = cmdMgr->getCmd(serverQueryCmds[i]);
+      if (e) queries.insert(e);
+   }
+   struct sigaction sa;
+   memset(&sa, 0, sizeof(sa));
+   sa.sa_handler = serverSignal;
+   sigaction(SIGINT, &sa, 0);
+   sigaction(SIGTERM, &sa, 0);
+   signal(SIGPIPE, SIG_IGN);
+   cout << "Serving on \"" << path << "\"..." << endl;
+
+   vector<ServerConn> conns;
+   vector<struct pollfd> fds;
+   while (!serverStop) {
+      // the listening socket, then per connection its socket or the pipe
+      // of its running query
+      fds.assign(1, pollfd());
+      fds[0].fd = lfd;
+      fds[0].events = POLLIN;
+      for (size_t i = 0; i < conns.size(); ++i) {
+         struct pollfd p;
+         p.fd = conns[i]._pid < 0 ? conns[i]._fd : conns[i]._done;
+         p.events = POLLIN;
+         p.revents = 0;
+         fds.push_back(p);
+      }
+      if (poll(&fds[0], fds.size(), -1) < 0) {
+         if (errno == EINTR) continue;
+         break;
+      }
+
+      for (size_t i = 0; i < conns.size(); ++i) {
+         ServerConn& c = conns[i];
+         const short ev = fds[i + 1].revents;
+         if (!ev) continue;
+         if (c._pid >= 0) {
+            int status = 0;
+            while (waitpid(c._pid, &status, 0) < 0 && errno == EINTR) ;
+            close(c._done);
+            c._pid = -1;
+            c._done = -1;
+            sendStatus(c, WIFEXITED(status) ? WEXITSTATUS(status)
+                                            : CMD_EXEC_ERROR);
+         }
+         else {
+            char buf[SERVER_READ];
+            const ssize_t n = recv(c._fd, buf, sizeof(buf), 0);
+            if (n > 0) c._in.append(buf, n);
+            else if (n == 0 || errno != EINTR) {
+               // a last line without a newline still runs
+               if (c._in.size()) c._in += '\n';
+               c._eof = true;
+            }
+         }
+         serveLines(c, queries, lfd, conns);
+      }
+      for (size_t i = 0; i < conns.size(); ) {
+         if (conns[i].isOver()) {
+            close(conns[i]._fd);
+            conns.erase(conns.begin() + i);
+         }
+         else ++i;
+      }
+
+      if (fds[0].revents & POLLIN) {
+         const int fd = accept(lfd, 0, 0);
+         if (fd >= 0) conns.push_back(ServerConn(fd));
+      }
+   }
+
+   for (size_t i = 0; i < conns.size(); ++i) {
+      if (conns[i]._pid >= 0) {
+         waitpid(conns[i]._pid, 0, 0);
+         close(conns[i]._done);
+      }
+      close(conns[i]._fd);
+   }
+   close(lfd);
+   unlink(path.c_str());
+   return true;
+}
@@ -1,4 +1,4 @@
-util.d: ../../include/util.h ../../include/rnGen.h ../../include/myUsage.h 
+util.d: ../../include/util.h ../../include/rnGen.h ../../include/myUsage.h ../../include/myWriter.h ../../include/myProfiler.h ../../include/myPerf.h 
 ../../include/util.h: util.h
 	@rm -f ../../include/util.h
 	@ln -fs ../src/util/util.h ../../include/util.h
@@ -8,3 +8,12 @@ util.d: ../../include/util.h ../../include/rnGen.h ../../include/myUsage.h
 ../../include/myUsage.h: myUsage.h
 	@rm -f ../../include/myUsage.h
 	@ln -fs ../src/util/myUsage.h ../../include/myUsage.h
+../../include/myWriter.h: myWriter.h
+	@rm -f ../../include/myWriter.h
+	@ln -fs ../src/util/myWriter.h ../../include/myWriter.h
+../../include/myProfiler.h: myProfiler.h
+	@rm -f ../../include/myProfiler.h
+	@ln -fs ../src/util/myProfiler.h ../../include/myProfiler.h
+../../include/myPerf.h: myPerf.h
+	@rm -f ../../include/myPerf.h
+	@ln -fs ../src/util/myPerf.h ../../include/myPerf.h
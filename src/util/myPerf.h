@@ -0,0 +1,198 @@
+/****************************************************************************
+  FileName     [ myPerf.h ]
+  PackageName  [ util ]
+  Synopsis     [ Hardware performance counters around the hot paths ]
+  Author       [ Chung-Yang (Ric) Huang ]
+  Copyright    [ Copyleft(c) 2007-present LaDs(III), GIEE, NTU, Taiwan ]
+****************************************************************************/
+
+#ifndef MY_PERF_H
+#define MY_PERF_H
+
+// Build with "make PERF=1" (after "make clean") to define MY_PERF; without
+// it the MY_PERF_* macros expand to nothing.
+//
+//    MY_PERF_SCOPE(s, "read/lines");   // counts until the end of the block
+//    MY_PERF_GATES(s, nGates);         // the gates the phase works on
+//    MY_PERF_NEXT(s, "read/parse");    // ends one phase, starts the next
+//    MY_PERF_REPORT(cout);             // IPC and misses per gate by phase
+//
+#ifdef MY_PERF
+
+#include <unistd.h>
+#include <stdint.h>
+#include <cstring>
+#include <iostream>
+#include <iomanip>
+#include <string>
+#include <map>
+#include <mutex>
+#include <sys/syscall.h>
+#include <linux/perf_event.h>
+
+using namespace std;
+
+enum MyPerfEvent
+{
+   PERF_CYCLES        = 0,
+   PERF_INSTRUCTIONS  = 1,
+   PERF_CACHE_MISSES  = 2,
+   PERF_BRANCH_MISSES = 3,
+
+   PERF_EVENT_TOT
+};
+
+// One counter per event for the user space of the whole process; the
+// counters are inherited by the threads created after they are opened and
+// the counts of a thread are added when it exits, so the phases run by
+// runParallel() are counted after their threads are joined.  Events the
+// kernel or the machine does not allow are reported as "-".
+class MyPerf
+{
+public:
+   MyPerf() {
+      for (unsigned k = 0; k < PERF_EVENT_TOT; ++k) _fd[k] = -1;
+   }
+   ~MyPerf() {
+      for (unsigned k = 0; k < PERF_EVENT_TOT; ++k)
+         if (_fd[k] >= 0) close(_fd[k]);
+   }
+
+   void read(uint64_t* v) {
+      call_once(_once, &MyPerf::open, this);
+      for (unsigned k = 0; k < PERF_EVENT_TOT; ++k)
+         if (_fd[k] < 0 || ::read(_fd[k], &v[k], sizeof(uint64_t)) !=
+             sizeof(uint64_t)) v[k] = 0;
+   }
+
+   void add(const char* phase, const uint64_t* b, const uint64_t* e,
+            size_t nGates) {
+      lock_guard<mutex> lock(_lock);
+      Record& r = _records[phase];
+      ++r._calls;
+      r._gates += nGates;
+      for (unsigned k = 0; k < PERF_EVENT_TOT; ++k) r._count[k] += e[k] - b[k];
+   }
+
+   void reset() {
+      lock_guard<mutex> lock(_lock);
+      _records.clear();
+   }
+
+   void report(ostream& os) {
+      lock_guard<mutex> lock(_lock);
+      if (_records.empty()) return;
+      os << setw(16) << left << "Phase" << right << setw(7) << "Calls"
+         << setw(12) << "Gates" << setw(12) << "Cycles(M)"
+         << setw(12) << "Instrs(M)" << setw(7) << "IPC"
+         << setw(13) << "CacheMiss/g" << setw(13) << "BrMiss/g" << endl;
+      for (map<string, Record>::const_iterator it = _records.begin();
+           it != _records.end(); ++it) {
+         const Record& r = it->second;
+         os << setw(16) << left << it->first << right << setw(7) << r._calls
+            << setw(12) << r._gates << fixed << setprecision(2);
+         putCount(os, PERF_CYCLES, r._count[PERF_CYCLES] / 1e6, 12);
+         putCount(os, PERF_INSTRUCTIONS, r._count[PERF_INSTRUCTIONS] / 1e6, 12);
+         if (_fd[PERF_CYCLES] >= 0 && _fd[PERF_INSTRUCTIONS] >= 0 &&
+             r._count[PERF_CYCLES])
+            os << setw(7) << double(r._count[PERF_INSTRUCTIONS]) /
+                             r._count[PERF_CYCLES];
+         else os << setw(7) << "-";
+         const double g = r._gates ? r._gates : 1;
+         putCount(os, PERF_CACHE_MISSES, r._count[PERF_CACHE_MISSES] / g, 13);
+         putCount(os, PERF_BRANCH_MISSES, r._count[PERF_BRANCH_MISSES] / g, 13);
+         os << endl;
+         os.unsetf(ios::floatfield);
+         os << setprecision(6);
+      }
+   }
+
+private:
+   struct Record {
+      Record(): _calls(0), _gates(0) { memset(_count, 0, sizeof(_count)); }
+
+      size_t     _calls;
+      size_t     _gates;
+      uint64_t   _count[PERF_EVENT_TOT];
+   };
+
+   once_flag             _once;
+   int                   _fd[PERF_EVENT_TOT];
+   map<string, Record>   _records;
+   mutex                 _lock;
+
+   void open() {
+      static const uint64_t config[PERF_EVENT_TOT] = {
+         PERF_COUNT_HW_CPU_CYCLES, PERF_COUNT_HW_INSTRUCTIONS,
+         PERF_COUNT_HW_CACHE_MISSES, PERF_COUNT_HW_BRANCH_MISSES
+      };
+      bool any = false;
+      for (unsigned k = 0; k < PERF_EVENT_TOT; ++k) {
+         struct perf_event_attr attr;
+         memset(&attr, 0, sizeof(attr));
+         attr.size = sizeof(attr);
+         attr.type = PERF_TYPE_HARDWARE;
+         attr.config = config[k];
+         attr.inherit = 1;
+         attr.exclude_kernel = 1;
+         attr.exclude_hv = 1;
+         _fd[k] = syscall(__NR_perf_event_open, &attr, 0, -1, -1, 0);
+         if (_fd[k] >= 0) any = true;
+      }
+      if (!any)
+         cerr << "Warning: hardware performance counters are not available!!"
+              << endl;
+   }
+   void putCount(ostream& os, MyPerfEvent k, double v, int w) const {
+      if (_fd[k] >= 0) os << setw(w) << v;
+      else os << setw(w) << "-";
+   }
+};
+
+extern MyPerf myPerf;
+
+// The counts from its construction to its destruction go to its phase;
+// next() splits them into consecutive phases of the same gates
+class MyPerfScope
+{
+public:
+   MyPerfScope(const char* phase, size_t nGates = 0): _phase(phase),
+      _gates(nGates) { myPerf.read(_begin); }
+   ~MyPerfScope() {
+      uint64_t end[PERF_EVENT_TOT];
+      myPerf.read(end);
+      myPerf.add(_phase, _begin, end, _gates);
+   }
+
+   void setGates(size_t n) { _gates = n; }
+   void next(const char* phase) {
+      uint64_t end[PERF_EVENT_TOT];
+      myPerf.read(end);
+      myPerf.add(_phase, _begin, end, _gates);
+      _phase = phase;
+      memcpy(_begin, end, sizeof(end));
+   }
+
+private:
+   const char*   _phase;
+   size_t        _gates;
+   uint64_t      _begin[PERF_EVENT_TOT];
+};
+
+#define MY_PERF_SCOPE(s, phase)   MyPerfScope s(phase)
+#define MY_PERF_GATES(s, n)       s.setGates(n)
+#define MY_PERF_NEXT(s, phase)    s.next(phase)
+#define MY_PERF_REPORT(os)        myPerf.report(os)
+#define MY_PERF_RESET()           myPerf.reset()
+
+#else // MY_PERF
+
+#define MY_PERF_SCOPE(s, phase)
+#define MY_PERF_GATES(s, n)
+#define MY_PERF_NEXT(s, phase)
+#define MY_PERF_REPORT(os)
+#define MY_PERF_RESET()
+
+#endif // MY_PERF
+
+#endif // MY_PERF_H
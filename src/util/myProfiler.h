@@ -0,0 +1,175 @@
+/****************************************************************************
+  FileName     [ myProfiler.h ]
+  PackageName  [ util ]
+  Synopsis     [ Accumulate the run time and memory usage of named tasks ]
+  Author       [ Chung-Yang (Ric) Huang ]
+  Copyright    [ Copyleft(c) 2007-present LaDs(III), GIEE, NTU, Taiwan ]
+****************************************************************************/
+
+#ifndef MY_PROFILER_H
+#define MY_PROFILER_H
+
+#include <unistd.h>
+#include <iostream>
+#include <iomanip>
+#include <fstream>
+#include <string>
+#include <vector>
+#include <map>
+#include <algorithm>
+#include <chrono>
+#include <sys/resource.h>
+
+using namespace std;
+
+enum MyProfSort
+{
+   PROF_SORT_WALL   = 0,
+   PROF_SORT_CPU    = 1,
+   PROF_SORT_CALLS  = 2,
+   PROF_SORT_RSS    = 3,
+   PROF_SORT_FAULTS = 4,
+   PROF_SORT_NAME   = 5,
+
+   PROF_SORT_TOT
+};
+
+// Wall time by steady_clock, user / system CPU and page faults by
+// getrusage(), and the current RSS from /proc/self/statm (0 where it does
+// not exist), taken before and after each task
+class MyProfiler
+{
+public:
+   struct Sample {
+      double   _wall;     // all times in seconds
+      double   _user;
+      double   _sys;
+      long     _rss;      // bytes
+      long     _minFlt;
+      long     _majFlt;
+   };
+
+   MyProfiler(): _on(false) {}
+
+   bool isOn() const { return _on; }
+   void enable(bool on) { _on = on; }
+   void reset() { _records.clear(); _index.clear(); }
+   bool empty() const { return _records.empty(); }
+
+   static void sample(Sample& s) {
+      s._wall = chrono::duration<double>(
+         chrono::steady_clock::now().time_since_epoch()).count();
+      struct rusage usage;
+      getrusage(RUSAGE_SELF, &usage);
+      s._user = usage.ru_utime.tv_sec + usage.ru_utime.tv_usec / 1e6;
+      s._sys = usage.ru_stime.tv_sec + usage.ru_stime.tv_usec / 1e6;
+      s._minFlt = usage.ru_minflt;
+      s._majFlt = usage.ru_majflt;
+      long size = 0, resident = 0;
+      ifstream statm("/proc/self/statm");
+      if (statm >> size >> resident) s._rss = resident * sysconf(_SC_PAGESIZE);
+      else s._rss = 0;
+   }
+
+   void add(const string& name, const Sample& b, const Sample& e) {
+      map<string, size_t>::iterator it = _index.find(name);
+      if (it == _index.end()) {
+         it = _index.insert(make_pair(name, _records.size())).first;
+         _records.push_back(Record(name));
+      }
+      Record& r = _records[it->second];
+      const double wall = e._wall - b._wall;
+      ++r._calls;
+      r._wall += wall;
+      r._wallMax = max(r._wallMax, wall);
+      r._user += e._user - b._user;
+      r._sys += e._sys - b._sys;
+      r._rss = e._rss;
+      r._rssDelta += e._rss - b._rss;
+      r._minFlt += e._minFlt - b._minFlt;
+      r._majFlt += e._majFlt - b._majFlt;
+   }
+
+   void report(ostream& os, MyProfSort key = PROF_SORT_WALL) const {
+      vector<const Record*> rows;
+      Record total("Total");
+      for (size_t i = 0; i < _records.size(); ++i) {
+         const Record& r = _records[i];
+         rows.push_back(&r);
+         total._calls += r._calls;
+         total._wall += r._wall;
+         total._wallMax = max(total._wallMax, r._wallMax);
+         total._user += r._user;
+         total._sys += r._sys;
+         total._rss = max(total._rss, r._rss);
+         total._rssDelta += r._rssDelta;
+         total._minFlt += r._minFlt;
+         total._majFlt += r._majFlt;
+      }
+      stable_sort(rows.begin(), rows.end(), RecordLess(key));
+
+      os << setw(14) << left << "Command" << right << setw(7) << "Calls"
+         << setw(12) << "Wall(ms)" << setw(12) << "Max(ms)"
+         << setw(12) << "User(ms)" << setw(12) << "Sys(ms)"
+         << setw(10) << "RSS(MB)" << setw(10) << "dRSS(MB)"
+         << setw(10) << "MinFlt" << setw(8) << "MajFlt" << endl;
+      for (size_t i = 0; i < rows.size(); ++i) reportRecord(os, *rows[i]);
+      os << string(107, '-') << endl;
+      reportRecord(os, total);
+   }
+
+private:
+   struct Record {
+      Record(const string& name): _name(name), _calls(0), _wall(0),
+         _wallMax(0), _user(0), _sys(0), _rss(0), _rssDelta(0), _minFlt(0),
+         _majFlt(0) {}
+
+      string     _name;
+      size_t     _calls;
+      double     _wall;
+      double     _wallMax;
+      double     _user;
+      double     _sys;
+      long       _rss;        // after the last call
+      long       _rssDelta;   // summed over the calls
+      long       _minFlt;
+      long       _majFlt;
+   };
+
+   // the largest first, except by name
+   struct RecordLess {
+      RecordLess(MyProfSort key): _key(key) {}
+      bool operator () (const Record* a, const Record* b) const {
+         switch (_key) {
+            case PROF_SORT_CPU:
+               return a->_user + a->_sys > b->_user + b->_sys;
+            case PROF_SORT_CALLS:  return a->_calls > b->_calls;
+            case PROF_SORT_RSS:    return a->_rss > b->_rss;
+            case PROF_SORT_FAULTS:
+               return a->_minFlt + a->_majFlt > b->_minFlt + b->_majFlt;
+            case PROF_SORT_NAME:   return a->_name < b->_name;
+            default:               return a->_wall > b->_wall;
+         }
+      }
+      MyProfSort _key;
+   };
+
+   bool                  _on;
+   vector<Record>        _records;
+   map<string, size_t>   _index;
+
+   static void reportRecord(ostream& os, const Record& r) {
+      const double mb = 1 << 20;
+      os << setw(14) << left << r._name << right << setw(7) << r._calls
+         << fixed << setprecision(3)
+         << setw(12) << r._wall * 1e3 << setw(12) << r._wallMax * 1e3
+         << setw(12) << r._user * 1e3 << setw(12) << r._sys * 1e3
+         << setprecision(2) << setw(10) << r._rss / mb
+         << showpos << setw(10) << r._rssDelta / mb << noshowpos
+         << setw(10) << r._minFlt << setw(8) << r._majFlt << endl;
+      os.unsetf(ios::floatfield);
+      os << setprecision(6);
+   }
+};
+
+#endif // MY_PROFILER_H
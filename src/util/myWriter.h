@@ -0,0 +1,101 @@
+/****************************************************************************
+  FileName     [ myWriter.h ]
+  PackageName  [ util ]
+  Synopsis     [ Buffered text writer for large reports ]
+  Author       [ Chung-Yang (Ric) Huang ]
+  Copyright    [ Copyleft(c) 2007-present LaDs(III), GIEE, NTU, Taiwan ]
+****************************************************************************/
+
+#ifndef MY_WRITER_H
+#define MY_WRITER_H
+
+#include <iostream>
+#include <string>
+#include <cstring>
+
+using namespace std;
+
+// Collect the text in a large buffer and pass it to the stream in big
+// blocks.  Use '\n' instead of endl; the stream is flushed only once, when
+// the writer is destroyed, e.g. at the end of a command.
+class MyWriter
+{
+public:
+   MyWriter(ostream& os, size_t capacity = 1 << 16):
+      _os(os), _buf(new char[capacity]), _cap(capacity), _n(0) {}
+   ~MyWriter() { flush(); delete [] _buf; }
+
+   MyWriter& operator << (char c) {
+      if (_n == _cap) spill();
+      _buf[_n++] = c;
+      return *this;
+   }
+   MyWriter& operator << (const char* s) { return write(s, strlen(s)); }
+   MyWriter& operator << (const string& s) { return write(s.data(), s.size()); }
+   MyWriter& operator << (int v) { return writeInt(v); }
+   MyWriter& operator << (long v) { return writeInt(v); }
+   MyWriter& operator << (unsigned v) { return writeUInt(v); }
+   MyWriter& operator << (unsigned long v) { return writeUInt(v); }
+
+   MyWriter& write(const char* s, size_t n) {
+      if (_n + n > _cap) {
+         spill();
+         if (n > _cap) { _os.write(s, n); return *this; }
+      }
+      memcpy(_buf + _n, s, n);
+      _n += n;
+      return *this;
+   }
+   MyWriter& fill(char c, size_t n) {
+      for (size_t i = 0; i < n; ++i) *this << c;
+      return *this;
+   }
+   // the same as setw(width) << right << v
+   MyWriter& right(unsigned long v, size_t width) {
+      char d[24];
+      const size_t n = toDigits(v, d + sizeof(d));
+      if (n < width) fill(' ', width - n);
+      return write(d + sizeof(d) - n, n);
+   }
+   // the same as setw(width) << left << s
+   MyWriter& left(const string& s, size_t width) {
+      write(s.data(), s.size());
+      return (s.size() < width) ? fill(' ', width - s.size()) : *this;
+   }
+
+   void flush() { spill(); _os.flush(); }
+
+private:
+   ostream&   _os;
+   char*      _buf;
+   size_t     _cap;
+   size_t     _n;
+
+   MyWriter(const MyWriter&);
+   MyWriter& operator = (const MyWriter&);
+
+   void spill() {
+      if (_n) _os.write(_buf, _n);
+      _n = 0;
+   }
+   // write the digits of v backwards from end; return the number of digits
+   static size_t toDigits(unsigned long v, char* end) {
+      char* p = end;
+      do { *--p = char('0' + v % 10); v /= 10; } while (v);
+      return end - p;
+   }
+   MyWriter& writeUInt(unsigned long v) {
+      char d[24];
+      const size_t n = toDigits(v, d + sizeof(d));
+      return write(d + sizeof(d) - n, n);
+   }
+   MyWriter& writeInt(long v) {
+      if (v < 0) {
+         *this << '-';
+         return writeUInt(0UL - (unsigned long)v);
+      }
+      return writeUInt(v);
+   }
+};
+
+#endif // MY_WRITER_H
@@ -16,6 +16,8 @@
 #include <algorithm>
 #include "rnGen.h"
 #include "myUsage.h"
+#include "myProfiler.h"
+#include "myPerf.h"
 
 using namespace std;
 
@@ -25,6 +27,10 @@ using namespace std;
 
 RandomNumGen  rnGen(0);  // use random seed = 0
 MyUsage       myUsage;
+MyProfiler    myProfiler;
+#ifdef MY_PERF
+MyPerf        myPerf;
+#endif
 
 
 //----------------------------------------------------------------------
@@ -11,12 +11,15 @@
 #include <istream>
 #include "rnGen.h"
 #include "myUsage.h"
+#include "myProfiler.h"
+#include "myPerf.h"
 
 using namespace std;
 
 // Extern global variable defined in util.cpp
 extern RandomNumGen  rnGen;
 extern MyUsage       myUsage;
+extern MyProfiler    myProfiler;
 
 // In myString.cpp
 extern int myStrNCmp(const string& s1, const string& s2, unsigned n);
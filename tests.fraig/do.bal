@@ -0,0 +1,41 @@
+cirr ISCAS85/C17.aag -r
+cirp -s
+cirb
+cirp -s
+cirr ISCAS85/C432.aag -r
+cirp -s
+cirb
+cirp -s
+cirr ISCAS85/C499.aag -r
+cirp -s
+cirb
+cirp -s
+cirr ISCAS85/C1355.aag -r
+cirp -s
+cirb
+cirp -s
+cirr ISCAS85/C1908.aag -r
+cirp -s
+cirb
+cirp -s
+cirr ISCAS85/C3540.aag -r
+cirp -s
+cirb
+cirp -s
+cirr ISCAS85/C5315.aag -r
+cirp -s
+cirb
+cirp -s
+cirr ISCAS85/C6288.aag -r
+cirp -s
+cirb
+cirp -s
+cirr sim07.aag -r
+cirp -s
+cirb
+cirp -s
+cirr sim06.aag -r
+cirp -s
+cirb
+cirp -s
+q -f